@@ -0,0 +1,110 @@
+#ifndef ANYTIME_HPP_INCLUDED
+#define ANYTIME_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace SeatingChartGenetic {
+
+using SearchClock = std::chrono::steady_clock;
+
+// The time `seconds` after `from`, or never for a budget of 0
+[[nodiscard]] inline SearchClock::time_point
+deadline_after(double seconds, SearchClock::time_point from = SearchClock::now());
+
+// Asks a search to stop, once a flag is raised by another thread or a deadline passes. The
+// climbers poll it between rows of a scan, every few hundred annealing steps and every tabu
+// iteration, so a search returns its best chart within a fraction of a millisecond of either,
+// even in the middle of a restart. A default token never stops and costs one branch a poll.
+class StopToken {
+    const std::atomic<bool>* flag     = nullptr;
+    SearchClock::time_point  deadline = SearchClock::time_point::max();
+
+   public:
+    constexpr StopToken() noexcept = default;
+
+    explicit StopToken(SearchClock::time_point at) noexcept : deadline{at} {}
+
+    explicit StopToken(const std::atomic<bool>& raised,
+                       SearchClock::time_point  at = SearchClock::time_point::max()) noexcept :
+        flag{&raised},
+        deadline{at} {}
+
+    [[nodiscard]] bool stop_requested() const noexcept;
+};
+
+// Score of the best chart over the time of a search, one point per new best, for choosing
+// budgets: the point after which a longer search stops paying is where the curve flattens.
+// Recorded by whichever thread finds the chart; new bests are rare, so a mutex will do.
+class ScoreTrace {
+    struct Point {
+        double      seconds;
+        std::size_t progress;
+        double      score;
+    };
+
+    SearchClock::time_point start = SearchClock::now();
+    mutable std::mutex      mutex;
+    std::vector<Point>      points;
+
+   public:
+    void restart_clock() { start = SearchClock::now(); }
+
+    // `progress` is the restart or generation that found the chart
+    void record(double score, std::size_t progress);
+
+    // A TSV table of seconds, progress and score, the progress column headed `progress_name`
+    [[nodiscard]] std::string tsv(const char* progress_name = "restart") const;
+};
+
+}
+
+namespace SeatingChartGenetic {
+
+inline SearchClock::time_point deadline_after(double seconds, SearchClock::time_point from) {
+    if (seconds <= 0)
+        return SearchClock::time_point::max();
+
+    return from + std::chrono::duration_cast<SearchClock::duration>(
+                    std::chrono::duration<double>(seconds));
+}
+
+inline bool StopToken::stop_requested() const noexcept {
+    if (flag && flag->load(std::memory_order_relaxed))
+        return true;
+
+    return deadline != SearchClock::time_point::max() && SearchClock::now() >= deadline;
+}
+
+inline void ScoreTrace::record(double score, std::size_t progress) {
+    const double seconds = std::chrono::duration<double>(SearchClock::now() - start).count();
+
+    std::lock_guard lock{mutex};
+
+    // Threads can finish out of order; only raises of the best so far belong on the curve
+    if (!points.empty() && score <= points.back().score)
+        return;
+
+    points.push_back({seconds, progress, score});
+}
+
+inline std::string ScoreTrace::tsv(const char* progress_name) const {
+    std::ostringstream text;
+    text << "seconds\t" << progress_name << "\tscore\n";
+
+    std::lock_guard lock{mutex};
+
+    for (const auto& point : points)
+        text << point.seconds << '\t' << point.progress << '\t' << point.score << '\n';
+
+    return text.str();
+}
+
+}
+
+#endif
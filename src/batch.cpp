@@ -0,0 +1,157 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace SeatingChartGenetic {
+
+namespace {
+
+template<typename T>
+bool parse_value(std::string_view text, T& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+}
+
+bool parse_manifest(std::string_view text, std::vector<BatchEntry>& entries, ParseError& error) {
+    for (std::size_t line_number = 1; !text.empty(); line_number++)
+    {
+        auto line = trim(next_field(text, '\n'));
+
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        BatchEntry entry;
+        entry.input = std::string{next_token(line)};
+
+        for (auto option = next_token(line); !option.empty(); option = next_token(line))
+        {
+            auto       value = option;
+            const auto key   = next_field(value, '=');
+            bool       valid = false;
+
+            if (key == "seconds")
+                valid = parse_value(value, entry.seconds) && entry.seconds > 0;
+            else if (key == "restarts")
+                valid = parse_value(value, entry.restarts) && entry.restarts > 0;
+            else if (key == "target")
+                valid = parse_value(value, entry.target.emplace());
+
+            if (!valid)
+            {
+                error = {line_number, "bad option '" + std::string{option}
+                                        + "', expected seconds=T, restarts=N or target=S"};
+                return false;
+            }
+        }
+
+        if (entry.seconds == 0 && entry.restarts == 0)
+        {
+            error = {line_number, "'" + entry.input + "' needs seconds=T or restarts=N"};
+            return false;
+        }
+
+        entries.push_back(std::move(entry));
+    }
+
+    return true;
+}
+
+BatchJob failed_batch_job(std::string error) {
+    return {0, [] { return false; }, [error = std::move(error)] {
+                BatchOutcome outcome;
+                outcome.error = error;
+                return outcome;
+            }};
+}
+
+std::vector<BatchOutcome> run_batch(std::vector<BatchJob>& jobs, std::size_t threads) {
+    struct Progress {
+        std::atomic<std::size_t> active{0};
+        std::atomic<bool>        over{false}, finished{false};
+    };
+
+    std::vector<Progress>     progress(jobs.size());
+    std::vector<BatchOutcome> outcomes(jobs.size());
+    std::vector<std::size_t>  order(jobs.size());
+
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t first, std::size_t second) {
+        return jobs[first].seats > jobs[second].seats;
+    });
+
+    std::atomic<std::size_t> next{0};
+
+    // The budget of a job ends before its workers leave, so whoever leaves last sees the
+    // job over and no one can still be running a restart when it finishes
+    const auto leave = [&](std::size_t job) {
+        if (progress[job].active.fetch_sub(1) == 1 && progress[job].over.load()
+            && !progress[job].finished.exchange(true))
+            outcomes[job] = jobs[job].finish();
+    };
+
+    // Among the jobs still running, the one with the most seats per worker on it
+    const auto steal = [&] {
+        std::size_t best = jobs.size();
+        double      most = 0;
+
+        for (const auto job : order)
+        {
+            if (progress[job].over.load())
+                continue;
+
+            const double share = static_cast<double>(jobs[job].seats + 1)
+                               / static_cast<double>(progress[job].active.load() + 1);
+
+            if (share > most)
+            {
+                best = job;
+                most = share;
+            }
+        }
+
+        return best;
+    };
+
+    const auto work = [&] {
+        while (true)
+        {
+            const auto claim = next.fetch_add(1);
+            const auto job   = claim < order.size() ? order[claim] : steal();
+
+            if (job == jobs.size())
+                return;
+
+            progress[job].active.fetch_add(1);
+
+            while (!progress[job].over.load(std::memory_order_relaxed))
+                if (!jobs[job].restart())
+                    progress[job].over.store(true);
+
+            leave(job);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    for (std::size_t i = 0; i < threads; i++)
+        workers.emplace_back(work);
+
+    for (auto& worker : workers)
+        worker.join();
+
+    return outcomes;
+}
+
+}
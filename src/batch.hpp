@@ -0,0 +1,174 @@
+#ifndef BATCH_HPP_INCLUDED
+#define BATCH_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "export.hpp"
+#include "parallelsearch.hpp"
+#include "parse.hpp"
+#include "seatingchart.hpp"
+#include "simulation.hpp"
+
+namespace SeatingChartGenetic {
+
+// One line of a batch manifest: an input file, then options as key=value, of which at least
+// one budget must be given and the search stops at the first one reached:
+//   seconds=T     wall time from the class's first restart
+//   restarts=N    restarts over all threads working on the class
+//   target=S      stop early once a chart scores at least S
+// Blank lines and lines starting with '#' are skipped.
+struct BatchEntry {
+    std::string           input;
+    double                seconds  = 0;
+    std::size_t           restarts = 0;
+    std::optional<double> target;
+};
+
+[[nodiscard]] bool parse_manifest(std::string_view, std::vector<BatchEntry>&, ParseError&);
+
+struct BatchOutcome {
+    double      score          = 0;
+    std::size_t restarts       = 0;
+    double      seconds        = 0;
+    bool        reached_target = false;
+
+    // Set when the class could not be searched, in which case the rest is meaningless
+    std::string error;
+};
+
+// A class of a batch, with its room size and scoring policy erased behind the calls the
+// scheduler makes. Any number of threads may call restart() at once; finish() is called once,
+// after the last restart.
+struct BatchJob {
+    std::size_t seats;
+
+    // Runs one restart, returning false once a budget or the target is reached
+    std::function<bool()> restart;
+
+    // Writes the best chart and reports on the search
+    std::function<BatchOutcome()> finish;
+};
+
+// A job that failed before searching, reported as such by the scheduler
+[[nodiscard]] BatchJob failed_batch_job(std::string);
+
+// The class is searched in the SearchLanes of `config`, its restart budget being the entry's,
+// so a class with neither a time budget nor a target finds the same chart on any thread count.
+// The best chart goes to `output`.
+template<std::size_t Row, std::size_t Column, typename Policy>
+[[nodiscard]] BatchJob make_batch_job(ParseResult<Row, Column>&&,
+                                      const BatchEntry&,
+                                      SearchConfig,
+                                      const Policy&,
+                                      std::string output);
+
+// Runs the jobs on `threads` threads, largest rooms first, and returns their outcomes in the
+// jobs' order. Workers claim restarts, not whole jobs: once every job has started, a worker
+// whose job is over steals restarts from the largest unfinished one, so the cores freed by
+// small rooms move to the large ones.
+[[nodiscard]] std::vector<BatchOutcome> run_batch(std::vector<BatchJob>&, std::size_t threads);
+
+}
+
+namespace SeatingChartGenetic {
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+BatchJob make_batch_job(ParseResult<Row, Column>&& parsed,
+                        const BatchEntry&          entry,
+                        SearchConfig               config,
+                        const Policy&              policy,
+                        std::string                output) {
+    using Clock = std::chrono::steady_clock;
+
+    config.restarts = entry.restarts;
+
+    struct State {
+        ParseResult<Row, Column>         parsed;
+        BatchEntry                       entry;
+        SearchConfig                     config;
+        std::string                      output;
+        SearchLanes<Row, Column, Policy> lanes;
+
+        std::atomic<std::size_t> completed{0};
+        std::atomic<bool>        over{false}, reached_target{false};
+        std::once_flag           started;
+        Clock::time_point        start;
+
+        State(ParseResult<Row, Column>&& result,
+              const BatchEntry&          batch_entry,
+              const SearchConfig&        search_config,
+              const Policy&              policy,
+              std::string&&              path) :
+            parsed{std::move(result)},
+            entry{batch_entry},
+            config{search_config},
+            output{std::move(path)},
+            lanes{parsed.chart, parsed.class_info, config, policy} {}
+    };
+
+    auto state = std::make_shared<State>(std::move(parsed), entry, config, policy, std::move(output));
+    const auto seats = state->parsed.chart.size();
+
+    const auto restart = [state] {
+        auto& s = *state;
+
+        std::call_once(s.started, [&] { s.start = Clock::now(); });
+
+        if (s.over.load(std::memory_order_relaxed))
+            return false;
+
+        // Once the job is over, restarts still running on other threads are cut short
+        const StopToken stop{s.over, deadline_after(s.entry.seconds, s.start)};
+
+        const bool ran = s.lanes.with_lane([&](SearchLane<Row, Column, Policy>& lane) {
+            const double score = lane.template restart<DefaultShuffleSwaps>(s.config, stop);
+
+            s.completed.fetch_add(1, std::memory_order_relaxed);
+
+            if (s.entry.target && score >= *s.entry.target - ScoreTolerance)
+                s.reached_target.store(true);
+        });
+
+        const bool expired = s.entry.seconds > 0
+                          && std::chrono::duration<double>(Clock::now() - s.start).count()
+                               >= s.entry.seconds;
+
+        if (!ran || s.reached_target.load() || expired)
+            s.over.store(true);
+
+        return !s.over.load(std::memory_order_relaxed);
+    };
+
+    const auto finish = [state] {
+        auto&       s    = *state;
+        const auto& best = s.lanes.best();
+
+        BatchOutcome outcome;
+        outcome.score          = best.best_score();
+        outcome.restarts       = s.completed.load();
+        outcome.seconds        = std::chrono::duration<double>(Clock::now() - s.start).count();
+        outcome.reached_target = s.reached_target.load();
+
+        ChartExporter<Row, Column> exporter{s.parsed.lookup_name};
+
+        if (!exporter.export_chart(best.best_chart(), s.output.c_str()))
+            outcome.error = "cannot write " + s.output;
+
+        return outcome;
+    };
+
+    return {seats, restart, finish};
+}
+
+}
+
+#endif
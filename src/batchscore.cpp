@@ -0,0 +1,144 @@
+#include "batchscore.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SEATINGCHART_X86 1
+#else
+#define SEATINGCHART_X86 0
+#endif
+
+namespace SeatingChartGenetic {
+
+namespace {
+
+using Kernel = void (*)(const BatchKernelInput&, double*) noexcept;
+
+void distance_scores_scalar(const BatchKernelInput& input, double* scores) noexcept {
+    std::array<double, BatchLanes> totals{};
+
+    for (std::size_t student = 0; student < input.students; student++)
+    {
+        const auto* seats = input.seats + student * BatchLanes;
+
+        for (auto i = input.upper_begin[student]; i < input.neighbour_offsets[student + 1]; i++)
+        {
+            const auto*  other_seats = input.seats + input.neighbours[i] * BatchLanes;
+            const double weight      = input.weights[i];
+
+            for (std::size_t lane = 0; lane < BatchLanes; lane++)
+                totals[lane] +=
+                  weight * input.inverse_distances[seats[lane] * input.students + other_seats[lane]];
+        }
+    }
+
+    for (std::size_t lane = 0; lane < BatchLanes; lane++)
+        scores[lane] = totals[lane];
+}
+
+#if SEATINGCHART_X86
+
+// Every related pair costs one gather of eight 1/d^2 entries, whose indices are the row
+// offsets of the student's seats plus the other student's seats.
+__attribute__((target("avx2"))) void distance_scores_avx2(const BatchKernelInput& input,
+                                                          double* scores) noexcept {
+    const auto students = _mm256_set1_epi32(static_cast<int>(input.students));
+
+    __m256d low  = _mm256_setzero_pd();
+    __m256d high = _mm256_setzero_pd();
+
+    for (std::size_t student = 0; student < input.students; student++)
+    {
+        const auto rows = _mm256_mullo_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input.seats + student * BatchLanes)),
+          students);
+
+        for (auto i = input.upper_begin[student]; i < input.neighbour_offsets[student + 1]; i++)
+        {
+            const auto indices = _mm256_add_epi32(
+              rows, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                      input.seats + input.neighbours[i] * BatchLanes)));
+            const auto weight = _mm256_set1_pd(input.weights[i]);
+
+            low = _mm256_add_pd(
+              low, _mm256_mul_pd(weight, _mm256_i32gather_pd(input.inverse_distances,
+                                                             _mm256_castsi256_si128(indices), 8)));
+            high = _mm256_add_pd(
+              high, _mm256_mul_pd(weight,
+                                  _mm256_i32gather_pd(input.inverse_distances,
+                                                      _mm256_extracti128_si256(indices, 1), 8)));
+        }
+    }
+
+    _mm256_storeu_pd(scores, low);
+    _mm256_storeu_pd(scores + 4, high);
+}
+
+__attribute__((target("avx2,avx512f"))) void distance_scores_avx512(const BatchKernelInput& input,
+                                                                    double* scores) noexcept {
+    const auto students = _mm256_set1_epi32(static_cast<int>(input.students));
+
+    __m512d totals = _mm512_setzero_pd();
+
+    for (std::size_t student = 0; student < input.students; student++)
+    {
+        const auto rows = _mm256_mullo_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input.seats + student * BatchLanes)),
+          students);
+
+        for (auto i = input.upper_begin[student]; i < input.neighbour_offsets[student + 1]; i++)
+        {
+            const auto indices = _mm256_add_epi32(
+              rows, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                      input.seats + input.neighbours[i] * BatchLanes)));
+
+            totals = _mm512_add_pd(
+              totals, _mm512_mul_pd(_mm512_set1_pd(input.weights[i]),
+                                    _mm512_i32gather_pd(indices, input.inverse_distances, 8)));
+        }
+    }
+
+    _mm512_storeu_pd(scores, totals);
+}
+
+#endif
+
+struct SelectedKernel {
+    Kernel           kernel;
+    std::string_view name;
+};
+
+SelectedKernel select_kernel() noexcept {
+#if SEATINGCHART_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+        return {distance_scores_avx512, "avx512"};
+
+    if (__builtin_cpu_supports("avx2"))
+        return {distance_scores_avx2, "avx2"};
+#endif
+
+    return {distance_scores_scalar, "scalar"};
+}
+
+const SelectedKernel selected = select_kernel();
+
+}
+
+void batch_distance_scores(const BatchKernelInput& input, double* scores) noexcept {
+    static_assert(BatchLanes == 8, "the vector kernels hold eight lanes");
+
+    if (input.students > MaxVectorStudents)
+        distance_scores_scalar(input, scores);
+    else
+        selected.kernel(input, scores);
+}
+
+std::string_view batch_kernel_name() noexcept { return selected.name; }
+
+}
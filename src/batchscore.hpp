@@ -0,0 +1,41 @@
+#ifndef BATCHSCORE_HPP_INCLUDED
+#define BATCHSCORE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace SeatingChartGenetic {
+
+// Charts scored together by one kernel call: eight doubles fill an AVX-512 register, or two
+// AVX2 registers.
+inline constexpr std::size_t BatchLanes = 8;
+
+// Gathers index the 1/d^2 table with signed 32-bit offsets, so larger rooms use scalar code.
+inline constexpr std::size_t MaxVectorStudents = 46340;
+
+// The distance terms of BatchLanes charts over the same class, in structure-of-arrays form:
+// seats[student * BatchLanes + lane] is the flattened seat of a student in the lane's chart.
+// Each unordered related pair is counted once, from the lower-numbered student's part of the
+// neighbour lists, neighbours[upper_begin[student] .. neighbour_offsets[student + 1]).
+struct BatchKernelInput {
+    const double*        inverse_distances;
+    std::size_t          students;
+    const std::uint32_t* upper_begin;
+    const std::uint32_t* neighbour_offsets;
+    const std::uint16_t* neighbours;
+    const double*        weights;
+    const std::uint32_t* seats;
+};
+
+// Writes the distance score of every lane. The kernel is picked once at startup from the
+// instruction sets the CPU reports, so a portable build still uses AVX2 or AVX-512 where
+// they exist.
+void batch_distance_scores(const BatchKernelInput&, double*) noexcept;
+
+// "avx512", "avx2" or "scalar"
+[[nodiscard]] std::string_view batch_kernel_name() noexcept;
+
+}
+
+#endif
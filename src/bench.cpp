@@ -0,0 +1,431 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "anytime.hpp"
+#include "dispatch.hpp"
+#include "exactsolver.hpp"
+#include "parallelsearch.hpp"
+#include "random.hpp"
+#include "seatingchart.hpp"
+#include "simulation.hpp"
+#include "stats.hpp"
+#include "synthetic.hpp"
+
+using namespace SeatingChartGenetic;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    SyntheticClass        spec;
+    double                seconds;
+    std::optional<double> target;
+    std::size_t           population;
+    std::size_t           threads;
+};
+
+template<typename T>
+bool parse_number(std::string_view text, T& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Heap allocations so far, counted only by builds with SEATINGCHART_STATS
+std::optional<double> allocations() {
+    if constexpr (!StatsEnabled)
+        return std::nullopt;
+
+    return stats_snapshot().counters[static_cast<std::size_t>(StatCounter::Allocations)];
+}
+
+// Set once a search allocates after warming up, which fails the run
+bool allocated_when_warm = false;
+
+std::optional<double> allocations_since(std::optional<double> before) {
+    const auto after = allocations();
+
+    if (!before || !after)
+        return std::nullopt;
+
+    allocated_when_warm = allocated_when_warm || *after > *before;
+    return *after - *before;
+}
+
+// One JSON object per line, keyed by benchmark and class so runs can be diffed and plotted.
+class Record {
+    std::ostringstream out;
+
+   public:
+    Record(std::string_view benchmark, const SyntheticClass& spec) {
+        out << std::setprecision(10) << "{\"benchmark\":\"" << benchmark << "\""
+            << ",\"rows\":" << spec.rows << ",\"columns\":" << spec.columns
+            << ",\"friends\":" << spec.friends_per_student
+            << ",\"enemies\":" << spec.enemies_per_student << ",\"seed\":" << spec.seed;
+    }
+
+    Record& field(std::string_view key, double value) {
+        out << ",\"" << key << "\":" << value;
+        return *this;
+    }
+
+    Record& field(std::string_view key, std::string_view value) {
+        out << ",\"" << key << "\":\"" << value << "\"";
+        return *this;
+    }
+
+    Record& field(std::string_view key, std::optional<double> value) {
+        if (value)
+            return field(key, *value);
+
+        out << ",\"" << key << "\":null";
+        return *this;
+    }
+
+    ~Record() { std::cout << out.str() << "}" << std::endl; }
+};
+
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+void bench_score_chart(const ParseResult<Row, Column>& parsed,
+                       const BenchOptions&             options,
+                       std::string_view                policy_name = "default",
+                       const Policy&                   policy      = {}) {
+    constexpr std::size_t Charts = 64, Batch = 4096;
+
+    Xoshiro256                             rng{options.spec.seed};
+    std::vector<SeatingChart<Row, Column>> charts(Charts, parsed.chart);
+
+    for (auto& chart : charts)
+        chart.random_shuffle(rng);
+
+    // Cycle through distinct charts so the compiler cannot hoist the call out of the loop
+    volatile double sink  = 0;
+    std::size_t     calls = 0;
+    const auto      start = Clock::now();
+
+    while (seconds_since(start) < options.seconds)
+    {
+        double sum = 0;
+
+        for (std::size_t i = 0; i < Batch; i++)
+            sum += score_chart(charts[i % Charts], parsed.class_info, policy);
+
+        sink = sink + sum;
+        calls += Batch;
+    }
+
+    Record{"score_chart", options.spec}
+      .field("policy", policy_name)
+      .field("calls_per_second", calls / seconds_since(start));
+}
+
+template<std::size_t Row, std::size_t Column>
+void bench_score_batch(const ParseResult<Row, Column>& parsed, const BenchOptions& options) {
+    constexpr std::size_t Charts = 64, Batch = 4096;
+
+    Xoshiro256                             rng{options.spec.seed};
+    std::vector<SeatingChart<Row, Column>> charts(Charts, parsed.chart);
+    std::vector<double>                    scores(Charts);
+    BatchScorer<Row, Column>               scorer{parsed.class_info};
+
+    for (auto& chart : charts)
+        chart.random_shuffle(rng);
+
+    volatile double sink  = 0;
+    std::size_t     calls = 0;
+    const auto      start = Clock::now();
+
+    while (seconds_since(start) < options.seconds)
+    {
+        double sum = 0;
+
+        for (std::size_t i = 0; i < Batch; i += Charts)
+        {
+            scorer.score(charts, scores);
+
+            for (const auto score : scores)
+                sum += score;
+        }
+
+        sink = sink + sum;
+        calls += Batch;
+    }
+
+    Record{"score_batch", options.spec}
+      .field("kernel", batch_kernel_name())
+      .field("calls_per_second", calls / seconds_since(start));
+}
+
+template<std::size_t Row, std::size_t Column>
+void bench_hill_climb(const ParseResult<Row, Column>& parsed, const BenchOptions& options) {
+    Xoshiro256                rng{options.spec.seed};
+    SeatingChart<Row, Column> chart{parsed.chart};
+    ChartScorer<Row, Column>  scorer{parsed.class_info};
+
+    std::size_t     steps = 0, climbs = 0;
+    const auto      start = Clock::now();
+    const StopToken stop{deadline_after(options.seconds, start)};
+
+    while (!stop.stop_requested())
+    {
+        chart.random_shuffle(rng, scorer);
+
+        while (chart.hill_climb_combined(scorer, stop))
+            steps++;
+
+        climbs++;
+    }
+
+    const double elapsed = seconds_since(start);
+
+    Record{"hill_climb_combined", options.spec}
+      .field("steps_per_second", steps / elapsed)
+      .field("steps_per_climb", static_cast<double>(steps) / climbs);
+}
+
+// A single search lane, timed rather than exporting charts. Returns the best score found.
+template<std::size_t Row, std::size_t Column>
+double bench_search(const ParseResult<Row, Column>& parsed,
+                  const BenchOptions&             options,
+                  std::string_view                name,
+                  const SearchConfig&             config) {
+    SearchLane<Row, Column> lane{parsed.chart, parsed.class_info, {}, options.spec.seed, 0, 1};
+
+    double                best_score = -1000, seconds_to_best = 0;
+    std::optional<double> seconds_to_target, warm_allocations;
+    std::size_t           restarts = 0;
+    const auto            start    = Clock::now();
+
+    // A restart can take far longer than the budget on large rooms, so it is cut short too
+    const StopToken stop{deadline_after(options.seconds, start)};
+
+    while (!stop.stop_requested())
+    {
+        const double score = lane.template restart<DefaultShuffleSwaps>(config, stop);
+
+        // The first restart builds the per-thread tables and scratch charts
+        if (restarts == 0)
+            warm_allocations = allocations();
+
+        restarts++;
+
+        if (score > best_score)
+        {
+            best_score      = score;
+            seconds_to_best = seconds_since(start);
+        }
+
+        if (options.target && score >= *options.target - ScoreTolerance)
+        {
+            seconds_to_target = seconds_since(start);
+            break;
+        }
+    }
+
+    const double elapsed   = seconds_since(start);
+    const auto   allocated = allocations_since(warm_allocations);
+
+    Record{"search", options.spec}
+      .field("strategy", name)
+      .field("restarts_per_second", restarts / elapsed)
+      .field("best_score", best_score)
+      .field("seconds_to_best", seconds_to_best)
+      .field("target", options.target)
+      .field("seconds_to_target", seconds_to_target)
+      .field("allocations_after_warmup", allocated);
+
+    return best_score;
+}
+
+template<std::size_t Row, std::size_t Column>
+void bench_genetic(const ParseResult<Row, Column>& parsed, const BenchOptions& options) {
+    Simulation<Row, Column> simulation{parsed.chart, parsed.class_info, options.population,
+                                       options.threads, options.spec.seed};
+
+    double                best_score = -1000, seconds_to_best = 0;
+    std::optional<double> seconds_to_target, warm_allocations;
+    std::size_t           generations = 0;
+    const auto            start       = Clock::now();
+
+    while (seconds_since(start) < options.seconds)
+    {
+        const auto [score] = simulation.step();
+
+        if (generations == 0)
+            warm_allocations = allocations();
+
+        generations++;
+
+        if (score > best_score)
+        {
+            best_score      = score;
+            seconds_to_best = seconds_since(start);
+        }
+
+        if (options.target && score >= *options.target - ScoreTolerance)
+        {
+            seconds_to_target = seconds_since(start);
+            break;
+        }
+    }
+
+    const double elapsed   = seconds_since(start);
+    const auto   allocated = allocations_since(warm_allocations);
+
+    Record{"search", options.spec}
+      .field("strategy", "genetic")
+      .field("threads", static_cast<double>(options.threads))
+      .field("generations_per_second", generations / elapsed)
+      .field("best_score", best_score)
+      .field("seconds_to_best", seconds_to_best)
+      .field("target", options.target)
+      .field("seconds_to_target", seconds_to_target)
+      .field("allocations_after_warmup", allocated);
+}
+
+// How far the heuristic's best chart is from the optimum, when the solver proves one within the
+// time limit; otherwise from the best chart the solver found
+template<std::size_t Row, std::size_t Column>
+void bench_exact(const ParseResult<Row, Column>& parsed,
+                 const BenchOptions&             options,
+                 double                          heuristic_best) {
+    ExactSolver<Row, Column> solver{parsed.class_info};
+
+    const auto start  = Clock::now();
+    const auto result = solver.solve(parsed.chart, {1, options.seconds, options.spec.seed});
+
+    Record{"exact", options.spec}
+      .field("best_score", result.score)
+      .field("optimal_score", result.optimal ? std::optional{result.score} : std::nullopt)
+      .field("heuristic_best", heuristic_best)
+      .field("gap", result.score - heuristic_best)
+      .field("nodes", static_cast<double>(result.nodes))
+      .field("seconds", seconds_since(start));
+}
+
+template<std::size_t Row, std::size_t Column>
+void run_benchmarks(const BenchOptions& options) {
+    const auto parsed = generate_class<Row, Column>(options.spec);
+
+    SearchConfig config{1,
+                        options.spec.seed,
+                        1500,
+                        SearchStrategy::HillClimb,
+                        {5.0, 0.05, 1000000, CoolingSchedule::Geometric},
+                        {5000, 40}};
+
+    bench_score_chart(parsed, options);
+
+    // The same lab benches under a compile-time and a runtime policy show what specialising
+    // the table loops buys
+    bench_score_chart(parsed, options, "static_4_euclidean", StaticScoring<4, EuclideanDistance>{});
+    bench_score_chart(parsed, options, "runtime_4_euclidean",
+                      RuntimeScoring{4, DistanceKind::Euclidean});
+    bench_score_batch(parsed, options);
+    bench_hill_climb(parsed, options);
+
+    double heuristic_best = std::numeric_limits<double>::lowest();
+
+    for (const auto& [name, strategy] : {std::pair{"hill_climb", SearchStrategy::HillClimb},
+                                         std::pair{"lookahead", SearchStrategy::Lookahead},
+                                         std::pair{"anneal", SearchStrategy::Anneal},
+                                         std::pair{"tabu", SearchStrategy::Tabu}})
+    {
+        config.strategy = strategy;
+        heuristic_best  = std::max(heuristic_best, bench_search(parsed, options, name, config));
+    }
+
+    bench_genetic(parsed, options);
+
+    if (parsed.chart.size() <= MaxExactSeats)
+        bench_exact(parsed, options, heuristic_best);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options{{6, 8, 3, 2, 1}, 2.0, std::nullopt, 1000, 2};
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view flag = argv[i];
+        double                 target;
+
+        if (i + 1 < argc && flag == "--rows" && parse_number(argv[i + 1], options.spec.rows)
+            && options.spec.rows > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--columns"
+                 && parse_number(argv[i + 1], options.spec.columns) && options.spec.columns > 0
+                 && options.spec.columns % 2 == 0)
+            i++;
+        else if (i + 1 < argc && flag == "--friends"
+                 && parse_number(argv[i + 1], options.spec.friends_per_student))
+            i++;
+        else if (i + 1 < argc && flag == "--enemies"
+                 && parse_number(argv[i + 1], options.spec.enemies_per_student))
+            i++;
+        else if (i + 1 < argc && flag == "--seed" && parse_number(argv[i + 1], options.spec.seed))
+            i++;
+        else if (i + 1 < argc && flag == "--seconds" && parse_number(argv[i + 1], options.seconds)
+                 && options.seconds > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--target" && parse_number(argv[i + 1], target))
+        {
+            options.target = target;
+            i++;
+        }
+        else if (i + 1 < argc && flag == "--population"
+                 && parse_number(argv[i + 1], options.population) && options.population > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--threads" && parse_number(argv[i + 1], options.threads)
+                 && options.threads > 0)
+            i++;
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--rows N] [--columns EVEN] [--friends N] [--enemies N] [--seed S]"
+                         " [--seconds T] [--target SCORE] [--population N] [--threads N]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.spec.rows > MaxStudents / options.spec.columns)
+    {
+        std::cerr << "More than " << MaxStudents << " students" << std::endl;
+        return 1;
+    }
+
+    // Every student needs that many distinct others to befriend and oppose
+    if (options.spec.friends_per_student + options.spec.enemies_per_student
+        >= options.spec.rows * options.spec.columns)
+    {
+        std::cerr << "Too many relationships per student for the room" << std::endl;
+        return 1;
+    }
+
+    dispatch_size(options.spec.rows, options.spec.columns,
+                  [&]<std::size_t Row, std::size_t Column>() {
+                      run_benchmarks<Row, Column>(options);
+                  });
+
+    if (allocated_when_warm)
+    {
+        std::cerr << "A search allocated after warming up" << std::endl;
+        return 1;
+    }
+}
@@ -1,82 +1,615 @@
 #ifndef CLASSINFO_HPP_INCLUDED
 #define CLASSINFO_HPP_INCLUDED
 
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#include "extent.hpp"
+#include "scoring.hpp"
+
 namespace SeatingChartGenetic {
 
+inline constexpr double TablemateWeight = 5.0;
+inline constexpr double FriendWeight    = 4.0;
+inline constexpr double EnemyWeight     = 3.0;
+
+// What a friend or enemy at the same table is worth, and the factors on the closeness of a
+// friend or enemy anywhere in the room.
+struct ScoreWeights {
+    double tablemate = TablemateWeight;
+    double friends   = FriendWeight;
+    double enemies   = EnemyWeight;
+};
+
+// Bounded by the dense pair tables rather than the 16-bit indices of the adjacency lists: a
+// class keeps a byte per pair of students and a search thread a double per pair of seats, 4 MiB
+// and 32 MiB at this size, where 65536 students would need 4 GiB and 32 GiB.
+inline constexpr std::size_t MaxStudents = 2048;
+
+// Compressed sparse rows: student i's list is targets[offsets[i] .. offsets[i + 1]).
+struct Adjacency {
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint16_t> targets;
+
+    [[nodiscard]] std::size_t size() const noexcept { return offsets.size() - 1; }
+
+    [[nodiscard]] std::span<const std::uint16_t> of(std::size_t student) const noexcept {
+        return {targets.data() + offsets[student], targets.data() + offsets[student + 1]};
+    }
+};
+
+// Packs one list of student indices per student, such as a relations_type. A student repeated
+// in a list is kept once, so every scorer counts a relationship the same number of times.
+template<typename Lists>
+[[nodiscard]] Adjacency make_adjacency(const Lists&);
+
+// Hard rules a chart must keep. Each student may sit only in their row of allowed_seats, as
+// flattened row-major seat numbers, where an empty row allows every seat and a single seat
+// pins the student; no pair in `apart` may share a table. Empty offsets mean no seat rules.
+struct SeatConstraints {
+    Adjacency                                            allowed_seats;
+    std::vector<std::pair<std::uint16_t, std::uint16_t>> apart;
+};
+
+// NumStudents is either fixed or Dynamic.
 template<size_t NumStudents>
 class ClassInfo {
-    std::array<std::vector<int>, NumStudents>              friends;
-    std::array<std::vector<int>, NumStudents>              enemies;
-    std::array<std::array<bool, NumStudents>, NumStudents> friends_lookup;
-    std::array<std::array<bool, NumStudents>, NumStudents> enemies_lookup;
+   public:
+    using relations_type = FixedOrDynamic<NumStudents, std::vector<int>>;
+
+   private:
+    static constexpr std::size_t WordBits = 64;
+
+    // Bit-packed lookups, one row of words per student; the word count is 0, and the storage a
+    // vector, when NumStudents is Dynamic
+    static constexpr std::size_t FixedWords = (NumStudents + WordBits - 1) / WordBits;
+    using lookup_type = FixedOrDynamic<NumStudents * FixedWords, std::uint64_t>;
+
+    Adjacency   friends;
+    Adjacency   enemies;
+    lookup_type friends_lookup;
+    lookup_type enemies_lookup;
+
+    // Everyone related to a student in either direction, with the symmetrised 1/d^2 weight
+    // of the pair, so swap deltas only walk the students a move can affect.
+    Adjacency          neighbours;
+    std::vector<double> neighbour_weights;
+
+    FixedOrDynamic<NumStudents, bool> related;
+
+    // Seat and table rules, with a bit per allowed seat and per pair kept apart; the bit rows
+    // of a Dynamic class are only allocated when it has constraints
+    SeatConstraints constraints_;
+    lookup_type     allowed_lookup;
+    lookup_type     apart_lookup;
+    bool            constrained_;
+
+    // Fixed-size classes are small enough to also keep dense rows of neighbour weights, which
+    // the swap deltas stream through with compile-time bounds
+    using dense_weights_type = std::conditional_t<NumStudents == Dynamic,
+                                                  std::monostate,
+                                                  std::array<double, NumStudents * NumStudents>>;
+
+    alignas(64) dense_weights_type dense_distance_weights;
+
+    // Relationship of every pair in both directions, 3 * friendships + enmities, indexing the
+    // weight tables below; a byte per pair keeps the swap deltas to one load per weight
+    FixedOrDynamic<NumStudents * NumStudents, std::uint8_t> pair_codes;
+
+    ScoreWeights          weights_;
+    std::array<double, 9> code_distance_weights;
+    std::array<double, 9> code_tablemate_weights;
+
+    // Fills every table derived from the weights
+    void apply_weights();
+
+    [[nodiscard]] constexpr bool test(const lookup_type&, std::size_t, std::size_t) const noexcept;
+
+    // Whether the chart keeps every rule once moved[2k] and moved[2k + 1] trade seats
+    template<typename Chart, typename Tables, std::size_t Moved>
+    [[nodiscard]] constexpr bool
+    allows_exchange(const Chart&, const Tables&, const std::array<std::size_t, Moved>&) const noexcept;
+
+    template<typename Chart>
+    [[nodiscard]] static constexpr std::size_t seat_of(const Chart&, std::size_t) noexcept;
 
    public:
-    template<
-      typename T,
-      typename U,
-      typename = typename std::enable_if_t<
-        std::is_same_v<std::remove_reference_t<T>, std::array<std::vector<int>, NumStudents>>,
-        bool>,
-      typename = typename std::enable_if_t<
-        std::is_same_v<std::remove_reference_t<U>, std::array<std::vector<int>, NumStudents>>,
-        bool>>
-    constexpr ClassInfo(T&&, U&&);
-    constexpr ClassInfo(const ClassInfo&) = default;
+    ClassInfo(Adjacency, Adjacency, SeatConstraints = {}, ScoreWeights = {});
+
+    template<typename T,
+             typename U,
+             typename = typename std::enable_if_t<
+               std::is_same_v<std::remove_reference_t<T>, relations_type>,
+               bool>,
+             typename = typename std::enable_if_t<
+               std::is_same_v<std::remove_reference_t<U>, relations_type>,
+               bool>>
+    ClassInfo(T&& f, U&& s, SeatConstraints c = {}, ScoreWeights w = {}) :
+        ClassInfo{make_adjacency(f), make_adjacency(s), std::move(c), w} {}
+
+    ClassInfo(const ClassInfo&)            = default;
+    ClassInfo(ClassInfo&&)                 = default;
+    ClassInfo& operator=(const ClassInfo&) = default;
+    ClassInfo& operator=(ClassInfo&&)      = default;
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return friends.size(); }
+    [[nodiscard]] constexpr std::size_t words_per_row() const noexcept {
+        return (size() + WordBits - 1) / WordBits;
+    }
 
     [[nodiscard]] constexpr bool friends_towards(std::size_t, std::size_t) const noexcept;
     [[nodiscard]] constexpr bool enemies_towards(std::size_t, std::size_t) const noexcept;
 
-    [[nodiscard]] constexpr const auto& enemies_of(std::size_t) const noexcept;
-    [[nodiscard]] constexpr const auto& friends_of(std::size_t) const noexcept;
+    [[nodiscard]] constexpr bool has_relationships(std::size_t) const noexcept;
+
+    [[nodiscard]] std::span<const std::uint16_t> enemies_of(std::size_t) const noexcept;
+    [[nodiscard]] std::span<const std::uint16_t> friends_of(std::size_t) const noexcept;
+
+    [[nodiscard]] std::span<const std::uint64_t> friends_bits_of(std::size_t) const noexcept;
+    [[nodiscard]] std::span<const std::uint64_t> enemies_bits_of(std::size_t) const noexcept;
+
+    [[nodiscard]] std::span<const std::uint16_t> neighbours_of(std::size_t) const noexcept;
+    [[nodiscard]] std::span<const double> neighbour_weights_of(std::size_t) const noexcept;
+
+    // Every student's neighbours and weights at once, for kernels that walk the whole class
+    [[nodiscard]] const Adjacency& neighbour_lists() const noexcept { return neighbours; }
+    [[nodiscard]] std::span<const double> neighbour_list_weights() const noexcept {
+        return neighbour_weights;
+    }
+
+    [[nodiscard]] constexpr std::span<const double, NumStudents>
+    distance_weights_of(std::size_t student) const noexcept
+      requires(NumStudents != Dynamic)
+    {
+        return std::span<const double, NumStudents>{
+          dense_distance_weights.data() + student * NumStudents, NumStudents};
+    }
+
+    [[nodiscard]] constexpr const ScoreWeights& weights() const noexcept { return weights_; }
+    void                                        set_weights(const ScoreWeights&);
+
+    // Symmetrised pair weights: distance weights scale the closeness of two seats, tablemate
+    // weights apply at a shared table.
+    [[nodiscard]] constexpr double distance_weight(std::size_t, std::size_t) const noexcept;
+    [[nodiscard]] constexpr double tablemate_weight(std::size_t, std::size_t) const noexcept;
+
+    [[nodiscard]] constexpr bool constrained() const noexcept { return constrained_; }
+    [[nodiscard]] const SeatConstraints& constraints() const noexcept { return constraints_; }
+    [[nodiscard]] std::span<const std::uint16_t> allowed_seats_of(std::size_t) const noexcept;
+
+    [[nodiscard]] constexpr bool may_sit(std::size_t, std::size_t) const noexcept;
+    [[nodiscard]] constexpr bool kept_apart(std::size_t, std::size_t) const noexcept;
+
+    // Whether a SeatingChart keeps every constraint, and whether its swap moves would, with
+    // tables laid out by a scoring policy. All of them are true for a class without
+    // constraints, after a single branch.
+    template<typename Chart, typename Tables = DefaultScoring>
+    [[nodiscard]] constexpr bool allows(const Chart&, const Tables& = {}) const noexcept;
+    template<typename Chart, typename Tables = DefaultScoring>
+    [[nodiscard]] constexpr bool
+    allows_swap_students(const Chart&, std::size_t, std::size_t, const Tables& = {}) const noexcept;
+    template<typename Chart, typename Tables = DefaultScoring>
+    [[nodiscard]] constexpr bool
+    allows_swap_pairs(const Chart&, std::size_t, std::size_t, const Tables& = {}) const noexcept;
+
+    // Whether nobody at the student's table is kept apart from them
+    template<typename Chart, typename Tables = DefaultScoring>
+    [[nodiscard]] constexpr bool sits_apart(const Chart&, std::size_t, const Tables& = {}) const noexcept;
 };
 
 }
 
 namespace SeatingChartGenetic {
 
+template<typename Lists>
+Adjacency make_adjacency(const Lists& lists) {
+    Adjacency adjacency{{0}, {}};
+    adjacency.offsets.reserve(std::size(lists) + 1);
+
+    // The list each student was last added to
+    std::vector<std::size_t> listed_in(std::size(lists), std::size(lists));
+
+    for (const auto& list : lists)
+    {
+        const auto current = adjacency.offsets.size() - 1;
+
+        for (const auto student : list)
+        {
+            assert(student >= 0 && static_cast<std::size_t>(student) < std::size(lists));
+
+            if (listed_in[student] == current)
+                continue;
+
+            listed_in[student] = current;
+            adjacency.targets.push_back(static_cast<std::uint16_t>(student));
+        }
+
+        adjacency.offsets.push_back(adjacency.targets.size());
+    }
+
+    return adjacency;
+}
+
 template<size_t NumStudents>
-template<typename T, typename U, typename, typename>
-constexpr ClassInfo<NumStudents>::ClassInfo(T&& f, U&& s) :
-    friends{std::forward<T>(f)},
-    enemies{std::forward<U>(s)},
-    friends_lookup{{{false}}},
-    enemies_lookup{{{false}}} {
-    using std::size;
+ClassInfo<NumStudents>::ClassInfo(Adjacency f, Adjacency s, SeatConstraints c, ScoreWeights w) :
+    friends{std::move(f)},
+    enemies{std::move(s)},
+    friends_lookup{make_fixed_or_dynamic<NumStudents * FixedWords, std::uint64_t>(
+      size() * words_per_row(), 0)},
+    enemies_lookup{friends_lookup},
+    related{make_fixed_or_dynamic<NumStudents, bool>(size(), false)},
+    constraints_{std::move(c)},
+    constrained_{!constraints_.allowed_seats.targets.empty() || !constraints_.apart.empty()},
+    pair_codes{
+      make_fixed_or_dynamic<NumStudents * NumStudents, std::uint8_t>(size() * size(), 0)},
+    weights_{w} {
+    assert(size() <= MaxStudents && enemies.size() == size());
+    assert(NumStudents == Dynamic || size() == NumStudents);
+
+    if (constraints_.allowed_seats.offsets.empty())
+        constraints_.allowed_seats.offsets.assign(size() + 1, 0);
+
+    assert(constraints_.allowed_seats.size() == size());
+
+    const auto constrained_words = constrained_ ? size() * words_per_row() : 0;
+
+    allowed_lookup = make_fixed_or_dynamic<NumStudents * FixedWords, std::uint64_t>(
+      constrained_words, ~std::uint64_t{0});
+    apart_lookup =
+      make_fixed_or_dynamic<NumStudents * FixedWords, std::uint64_t>(constrained_words, 0);
+
+    if (constrained_)
+    {
+        for (std::size_t student = 0; student < size(); student++)
+        {
+            const auto seats = constraints_.allowed_seats.of(student);
+
+            if (seats.empty())
+                continue;
+
+            auto* row = allowed_lookup.data() + student * words_per_row();
+            std::fill(row, row + words_per_row(), 0);
 
-    for (std::size_t student = 0; student < size(friends); student++)
-        for (const auto stu_friend : friends[student])
-            friends_lookup[student][stu_friend] = true;
+            for (const auto seat : seats)
+            {
+                assert(seat < size());
+                row[seat / WordBits] |= std::uint64_t{1} << (seat % WordBits);
+            }
+        }
 
-    for (std::size_t student = 0; student < size(enemies); student++)
-        for (const auto stu_enemy : enemies[student])
-            enemies_lookup[student][stu_enemy] = true;
+        for (const auto& [first, second] : constraints_.apart)
+        {
+            assert(first < size() && second < size());
+            apart_lookup[first * words_per_row() + second / WordBits] |= std::uint64_t{1}
+                                                                        << (second % WordBits);
+            apart_lookup[second * words_per_row() + first / WordBits] |= std::uint64_t{1}
+                                                                        << (first % WordBits);
+        }
+    }
+
+    std::vector<std::uint32_t> degree(size() + 1);
+
+    for (auto [relations, lookup, code] : {std::tuple{&friends, &friends_lookup, 3},
+                                           std::tuple{&enemies, &enemies_lookup, 1}})
+    {
+        for (std::size_t student = 0; student < size(); student++)
+        {
+            for (const auto other : relations->of(student))
+            {
+                // make_adjacency and open_snapshot keep every student once a list
+                assert(!test(*lookup, student, other));
+
+                (*lookup)[student * words_per_row() + other / WordBits] |=
+                  std::uint64_t{1} << (other % WordBits);
+
+                pair_codes[student * size() + other] += code;
+                pair_codes[other * size() + student] += code;
+
+                related[student] = true;
+                related[other]   = true;
+
+                degree[student]++;
+                degree[other]++;
+            }
+        }
+    }
+
+    // Counting sort of both directions of every relationship into rows, then each row is
+    // sorted and deduplicated in place
+    neighbours.offsets.assign(size() + 1, 0);
+
+    for (std::size_t student = 0; student < size(); student++)
+        neighbours.offsets[student + 1] = neighbours.offsets[student] + degree[student];
+
+    std::vector<std::uint32_t> cursor(neighbours.offsets.begin(), neighbours.offsets.end() - 1);
+    neighbours.targets.resize(neighbours.offsets.back());
+
+    for (const auto* relations : {&friends, &enemies})
+    {
+        for (std::size_t student = 0; student < size(); student++)
+        {
+            for (const auto other : relations->of(student))
+            {
+                neighbours.targets[cursor[student]++] = other;
+                neighbours.targets[cursor[other]++]   = static_cast<std::uint16_t>(student);
+            }
+        }
+    }
+
+    std::uint32_t written = 0;
+
+    for (std::size_t student = 0; student < size(); student++)
+    {
+        const auto begin = neighbours.targets.begin() + neighbours.offsets[student];
+        const auto end   = neighbours.targets.begin() + neighbours.offsets[student + 1];
+
+        std::sort(begin, end);
+
+        neighbours.offsets[student] = written;
+
+        for (auto other = begin; other != end; ++other)
+            if (other == begin || *other != *(other - 1))
+                neighbours.targets[written++] = *other;
+    }
+
+    neighbours.offsets[size()] = written;
+    neighbours.targets.resize(written);
+    neighbours.targets.shrink_to_fit();
+
+    apply_weights();
+}
+
+template<size_t NumStudents>
+void ClassInfo<NumStudents>::apply_weights() {
+    for (int code = 0; code < 9; code++)
+    {
+        code_distance_weights[code]  = weights_.friends * (code / 3) - weights_.enemies * (code % 3);
+        code_tablemate_weights[code] = weights_.tablemate * (code / 3 - code % 3);
+    }
+
+    if constexpr (NumStudents != Dynamic)
+        for (std::size_t first = 0; first < size(); first++)
+            for (std::size_t second = 0; second < size(); second++)
+                dense_distance_weights[first * size() + second] = distance_weight(first, second);
+
+    neighbour_weights.clear();
+    neighbour_weights.reserve(neighbours.targets.size());
+
+    for (std::size_t student = 0; student < size(); student++)
+        for (const auto other : neighbours.of(student))
+            neighbour_weights.push_back(distance_weight(student, other));
+}
+
+template<size_t NumStudents>
+void ClassInfo<NumStudents>::set_weights(const ScoreWeights& weights) {
+    weights_ = weights;
+    apply_weights();
+}
+
+template<size_t NumStudents>
+constexpr bool ClassInfo<NumStudents>::test(const lookup_type& lookup,
+                                            std::size_t        stu_from,
+                                            std::size_t        stu_to) const noexcept {
+    return (lookup[stu_from * words_per_row() + stu_to / WordBits] >> (stu_to % WordBits)) & 1;
 }
 
 template<size_t NumStudents>
 constexpr bool ClassInfo<NumStudents>::friends_towards(std::size_t stu_from,
                                                        std::size_t stu_to) const noexcept {
-    return friends_lookup[stu_from][stu_to];
+    return test(friends_lookup, stu_from, stu_to);
 }
 
 template<size_t NumStudents>
 constexpr bool ClassInfo<NumStudents>::enemies_towards(std::size_t stu_from,
                                                        std::size_t stu_to) const noexcept {
-    return enemies_lookup[stu_from][stu_to];
+    return test(enemies_lookup, stu_from, stu_to);
+}
+
+// Whether the student appears in any friend or enemy relationship, in either direction
+template<size_t NumStudents>
+constexpr bool ClassInfo<NumStudents>::has_relationships(std::size_t student) const noexcept {
+    return related[student];
+}
+
+template<size_t NumStudents>
+std::span<const std::uint16_t>
+ClassInfo<NumStudents>::friends_of(std::size_t student) const noexcept {
+    return friends.of(student);
+}
+
+template<size_t NumStudents>
+std::span<const std::uint16_t>
+ClassInfo<NumStudents>::enemies_of(std::size_t student) const noexcept {
+    return enemies.of(student);
 }
 
 template<size_t NumStudents>
-constexpr const auto& ClassInfo<NumStudents>::friends_of(std::size_t student) const noexcept {
-    return friends[student];
+std::span<const std::uint64_t>
+ClassInfo<NumStudents>::friends_bits_of(std::size_t student) const noexcept {
+    return {friends_lookup.data() + student * words_per_row(), words_per_row()};
 }
 
 template<size_t NumStudents>
-constexpr const auto& ClassInfo<NumStudents>::enemies_of(std::size_t student) const noexcept {
-    return enemies[student];
+std::span<const std::uint64_t>
+ClassInfo<NumStudents>::enemies_bits_of(std::size_t student) const noexcept {
+    return {enemies_lookup.data() + student * words_per_row(), words_per_row()};
 }
 
+template<size_t NumStudents>
+std::span<const std::uint16_t>
+ClassInfo<NumStudents>::neighbours_of(std::size_t student) const noexcept {
+    return neighbours.of(student);
+}
+
+template<size_t NumStudents>
+std::span<const double>
+ClassInfo<NumStudents>::neighbour_weights_of(std::size_t student) const noexcept {
+    return {neighbour_weights.data() + neighbours.offsets[student],
+            neighbour_weights.data() + neighbours.offsets[student + 1]};
+}
+
+template<size_t NumStudents>
+constexpr double ClassInfo<NumStudents>::distance_weight(std::size_t first,
+                                                         std::size_t second) const noexcept {
+    return code_distance_weights[pair_codes[first * size() + second]];
+}
+
+template<size_t NumStudents>
+std::span<const std::uint16_t>
+ClassInfo<NumStudents>::allowed_seats_of(std::size_t student) const noexcept {
+    return constraints_.allowed_seats.of(student);
+}
+
+template<size_t NumStudents>
+constexpr bool ClassInfo<NumStudents>::may_sit(std::size_t student,
+                                               std::size_t seat) const noexcept {
+    return !constrained_ || test(allowed_lookup, student, seat);
+}
+
+template<size_t NumStudents>
+constexpr bool ClassInfo<NumStudents>::kept_apart(std::size_t first,
+                                                  std::size_t second) const noexcept {
+    return constrained_ && test(apart_lookup, first, second);
+}
+
+template<size_t NumStudents>
+template<typename Chart>
+constexpr std::size_t ClassInfo<NumStudents>::seat_of(const Chart&      chart,
+                                                      std::size_t student) noexcept {
+    const auto [row, column] = chart.locations()[student];
+    return row * chart.columns() + column;
+}
+
+template<size_t NumStudents>
+template<typename Chart, typename Tables>
+constexpr bool ClassInfo<NumStudents>::allows(const Chart& chart, const Tables& tables) const noexcept {
+    if (!constrained_)
+        return true;
+
+    for (std::size_t student = 0; student < size(); student++)
+        if (!may_sit(student, seat_of(chart, student)))
+            return false;
+
+    for (const auto& [first, second] : constraints_.apart)
+    {
+        const auto [first_row, first_column]   = chart.locations()[first];
+        const auto [second_row, second_column] = chart.locations()[second];
+
+        if (first_row == second_row
+            && table_begin(tables, first_column) == table_begin(tables, second_column))
+            return false;
+    }
+
+    return true;
+}
+
+template<size_t NumStudents>
+template<typename Chart, typename Tables, std::size_t Moved>
+constexpr bool
+ClassInfo<NumStudents>::allows_exchange(const Chart&                          chart,
+                                        const Tables&                         tables,
+                                        const std::array<std::size_t, Moved>& moved) const noexcept {
+    std::array<std::size_t, Moved> new_seats;
+
+    for (std::size_t i = 0; i < Moved; i++)
+    {
+        new_seats[i] = seat_of(chart, moved[i ^ 1]);
+
+        if (!may_sit(moved[i], new_seats[i]))
+            return false;
+    }
+
+    if (constraints_.apart.empty())
+        return true;
+
+    const auto columns  = chart.columns();
+    const auto occupant = [&](const std::size_t seat) {
+        for (std::size_t i = 0; i < Moved; i++)
+            if (new_seats[i] == seat)
+                return moved[i];
+
+        return static_cast<std::size_t>(chart.seats()[seat / columns][seat % columns]);
+    };
+
+    for (std::size_t i = 0; i < Moved; i++)
+    {
+        const auto row    = new_seats[i] / columns;
+        const auto column = new_seats[i] % columns;
+
+        for (auto mate = table_begin(tables, column); mate < table_end(tables, column, columns);
+             mate++)
+            if (mate != column && kept_apart(moved[i], occupant(row * columns + mate)))
+                return false;
+    }
+
+    return true;
+}
+
+// Both students take the other's seat, and with it the other's table
+template<size_t NumStudents>
+template<typename Chart, typename Tables>
+constexpr bool ClassInfo<NumStudents>::allows_swap_students(const Chart&  chart,
+                                                            std::size_t   first,
+                                                            std::size_t   second,
+                                                            const Tables& tables) const noexcept {
+    if (!constrained_ || first == second)
+        return true;
+
+    return allows_exchange(chart, tables, std::array<std::size_t, 2>{first, second});
+}
+
+// The two students and their tablemates under the policy's tables trade seats pairwise, which
+// moves whole tables when the policy seats two at a table
+template<size_t NumStudents>
+template<typename Chart, typename Tables>
+constexpr bool ClassInfo<NumStudents>::allows_swap_pairs(const Chart&  chart,
+                                                         std::size_t   first,
+                                                         std::size_t   second,
+                                                         const Tables& tables) const noexcept {
+    if (!constrained_ || first == second)
+        return true;
+
+    const auto first_tablemate  = chart.get_tablemate(first, tables.table_seats());
+    const auto second_tablemate = chart.get_tablemate(second, tables.table_seats());
+
+    return first_tablemate == second
+        || allows_exchange(
+             chart, tables,
+             std::array<std::size_t, 4>{first, second, first_tablemate, second_tablemate});
+}
+
+template<size_t NumStudents>
+template<typename Chart, typename Tables>
+constexpr bool ClassInfo<NumStudents>::sits_apart(const Chart&  chart,
+                                                  std::size_t   student,
+                                                  const Tables& tables) const noexcept {
+    if (!constrained_)
+        return true;
+
+    const auto [row, column] = chart.locations()[student];
+
+    for (auto mate = table_begin(tables, column); mate < table_end(tables, column, chart.columns());
+         mate++)
+        if (mate != column && kept_apart(student, chart.seats()[row][mate]))
+            return false;
+
+    return true;
+}
+
+template<size_t NumStudents>
+constexpr double ClassInfo<NumStudents>::tablemate_weight(std::size_t first,
+                                                          std::size_t second) const noexcept {
+    return code_tablemate_weights[pair_codes[first * size() + second]];
+}
 
 }
 
@@ -0,0 +1,50 @@
+#ifndef DISPATCH_HPP_INCLUDED
+#define DISPATCH_HPP_INCLUDED
+
+#include <cstddef>
+
+#include "extent.hpp"
+#include "scoring.hpp"
+
+namespace SeatingChartGenetic {
+
+// Calls `function.template operator()<Row, Column>()` with the fixed-size instantiation for
+// the room sizes we run most, so their loops keep compile-time bounds and constexpr tables;
+// every other size runs on the Dynamic instantiation.
+template<typename Function>
+decltype(auto) dispatch_size(std::size_t rows, std::size_t columns, Function&& function) {
+    if (rows == 5 && columns == 6)
+        return function.template operator()<5, 6>();
+
+    if (rows == 6 && columns == 8)
+        return function.template operator()<6, 8>();
+
+    if (rows == 8 && columns == 8)
+        return function.template operator()<8, 8>();
+
+    return function.template operator()<Dynamic, Dynamic>();
+}
+
+// Calls `function(policy)` with the StaticScoring matching `scoring` for the layouts we run
+// most, two-seat tables and lab benches of three or four, all with 1/d^2; anything else, or
+// `runtime` being set, runs on the RuntimeScoring itself.
+template<typename Function>
+decltype(auto) dispatch_scoring(const RuntimeScoring& scoring, bool runtime, Function&& function) {
+    if (!runtime && scoring.distance() == DistanceKind::Euclidean)
+    {
+        if (scoring.table_seats() == 2)
+            return function(DefaultScoring{});
+
+        if (scoring.table_seats() == 3)
+            return function(StaticScoring<3, EuclideanDistance>{});
+
+        if (scoring.table_seats() == 4)
+            return function(StaticScoring<4, EuclideanDistance>{});
+    }
+
+    return function(scoring);
+}
+
+}
+
+#endif
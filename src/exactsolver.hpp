@@ -0,0 +1,764 @@
+#ifndef EXACTSOLVER_HPP_INCLUDED
+#define EXACTSOLVER_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "classinfo.hpp"
+#include "random.hpp"
+#include "scoring.hpp"
+#include "seatingchart.hpp"
+#include "simulation.hpp"
+#include "stats.hpp"
+
+namespace SeatingChartGenetic {
+
+// Largest room the exact solver takes; the tree grows factorially past it
+inline constexpr std::size_t MaxExactSeats = 20;
+
+struct ExactSettings {
+    std::size_t threads;
+
+    // Wall-clock budget, or 0 for none
+    double seconds;
+
+    // Seeds the random restarts that find the first best chart
+    std::uint64_t seed;
+};
+
+template<std::size_t Row, std::size_t Column>
+struct ExactResult {
+    SeatingChart<Row, Column> chart;
+    double                    score;
+
+    // False when the budget ran out first, leaving the best chart found
+    bool        optimal;
+    std::size_t nodes;
+};
+
+// Branch and bound over the ways to seat a small class. Students are seated one at a time,
+// each next to as many already seated relations as possible, and every placement adds its
+// terms with the students already seated. A node is pruned unless its score plus an upper
+// bound on the rest beats the best chart so far; the bound seats the unseated students in
+// distinct free seats, crediting each with their best case against everyone, see bound().
+//
+// Mirroring the room front to back, and side to side when tables divide the rows evenly,
+// preserves every score, so the first student only tries seats in one half or quarter of the
+// room, and only the first column when just rows count. Seat rules break the symmetry, so
+// constrained classes search every seat. The first four levels of the tree are split into
+// subtrees which the threads take best bound first, sharing the best score for pruning.
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+class ExactSolver {
+    static constexpr std::size_t Unseated = std::numeric_limits<std::size_t>::max();
+    static constexpr std::size_t SplitDepth = 4;
+
+    // Value of a seat a student may not take, low enough that no assignment uses one it can avoid
+    static constexpr double Unassignable = 1e6;
+
+    // Hill climbs from random charts before the tree search; the better the first best chart,
+    // the more the bound prunes
+    static constexpr std::size_t WarmStartRestarts = 500;
+
+    using Values = std::array<double, MaxExactSeats>;
+    using Matrix = std::array<Values, MaxExactSeats>;
+
+    struct Task {
+        std::array<std::size_t, SplitDepth> seats;
+        double                              bound;
+    };
+
+    // Seats taken so far by one thread, and the gain of every unseated student in every seat
+    // against the seated ones, one matrix per depth so backtracking is free
+    struct Worker {
+        std::array<std::size_t, MaxExactSeats> seat_of;
+        std::array<std::size_t, MaxExactSeats> student_at;
+        std::vector<Matrix>                    gains;
+        Matrix                                 values;
+        std::array<std::size_t, MaxExactSeats> best_student_at;
+        double                                 best_score = std::numeric_limits<double>::lowest();
+        std::size_t                            nodes      = 0;
+    };
+
+    const ClassInfo<Row * Column>& class_info;
+    [[no_unique_address]] Policy   policy;
+
+    std::size_t size_ = 0, rows_ = 0, columns_ = 0;
+    bool        symmetric = false;
+
+    Matrix distance_weights, tablemate_weights, closeness;
+    std::array<std::array<bool, MaxExactSeats>, MaxExactSeats> shares_table;
+
+    // Closeness from each seat to the others, nearest first and farthest first, and how many
+    // others share its table
+    Matrix                                 nearest, farthest;
+    std::array<std::size_t, MaxExactSeats> table_places;
+
+    // Everyone each student has a weight towards, by distance weight and by positive tablemate
+    // weight, both descending
+    using Relations = std::array<std::pair<double, std::size_t>, MaxExactSeats>;
+
+    std::array<Relations, MaxExactSeats>   relations, tablemates;
+    std::array<std::size_t, MaxExactSeats> relation_count, tablemate_count;
+
+    // Seating order, with the students that have relationships first, and where each student
+    // comes in it
+    std::array<std::size_t, MaxExactSeats> order, position;
+    std::size_t                            related_count = 0;
+
+    // Half of unseated_terms, by depth, student and seat; the order fixes who is unseated at
+    // each depth, so it does not depend on the seats taken
+    std::vector<Matrix> unseated_halves;
+
+    std::atomic<double>                   best_score_;
+    std::atomic<bool>                     out_of_time;
+    std::chrono::steady_clock::time_point deadline;
+    bool                                  has_deadline = false;
+
+    [[nodiscard]] double term(std::size_t, std::size_t, std::size_t, std::size_t) const noexcept;
+    [[nodiscard]] double unseated_terms(std::size_t, std::size_t, std::size_t) const noexcept;
+    [[nodiscard]] bool   may_seat(const Worker&, std::size_t, std::size_t) const noexcept;
+    [[nodiscard]] bool   canonical(std::size_t) const noexcept;
+
+    void   prepare(const SeatingChart<Row, Column>&);
+    void   reset(Worker&) const;
+    void   seat(Worker&, std::size_t, std::size_t) const;
+    void   unseat(Worker&, std::size_t) const;
+    double bound(Worker&, std::size_t, double, double) const;
+    void   record(Worker&, double);
+    void   descend(Worker&, std::size_t, double);
+
+    [[nodiscard]] static double
+    assignment(const Matrix&, const Values&, std::size_t, std::size_t, double) noexcept;
+
+    [[nodiscard]] std::vector<Task> split();
+
+   public:
+    explicit ExactSolver(const ClassInfo<Row * Column>&, Policy = {});
+
+    // `start` must keep the class's constraints; it seeds the random restarts
+    [[nodiscard]] ExactResult<Row, Column> solve(const SeatingChart<Row, Column>&,
+                                                 const ExactSettings&);
+};
+
+}
+
+namespace SeatingChartGenetic {
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+ExactSolver<Row, Column, Policy>::ExactSolver(const ClassInfo<Row * Column>& cinfo, Policy p) :
+    class_info{cinfo},
+    policy{p},
+    best_score_{0},
+    out_of_time{false} {}
+
+// What the pair scores with `first` in seat `first_seat` and `second` in `second_seat`
+template<std::size_t Row, std::size_t Column, typename Policy>
+double ExactSolver<Row, Column, Policy>::term(std::size_t first,
+                                              std::size_t second,
+                                              std::size_t first_seat,
+                                              std::size_t second_seat) const noexcept {
+    return distance_weights[first][second] * closeness[first_seat][second_seat]
+         + (shares_table[first_seat][second_seat] ? tablemate_weights[first][second] : 0.0);
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+bool ExactSolver<Row, Column, Policy>::may_seat(const Worker& worker,
+                                                std::size_t   student,
+                                                std::size_t   seat) const noexcept {
+    if (worker.student_at[seat] != Unseated || !class_info.may_sit(student, seat))
+        return false;
+
+    if (!class_info.constrained())
+        return true;
+
+    for (std::size_t other = 0; other < size_; other++)
+        if (shares_table[seat][other] && worker.student_at[other] != Unseated
+            && class_info.kept_apart(student, worker.student_at[other]))
+            return false;
+
+    return true;
+}
+
+// Whether a seat is the first, row-major, of its images under the room's mirrors
+template<std::size_t Row, std::size_t Column, typename Policy>
+bool ExactSolver<Row, Column, Policy>::canonical(std::size_t seat) const noexcept {
+    const auto row    = seat / columns_;
+    const auto column = seat % columns_;
+
+    if (row > rows_ - 1 - row)
+        return false;
+
+    if (columns_ % policy.table_seats() != 0)
+        return true;
+
+    // Tables, and seats within a table, can then be reordered freely along a row
+    if (policy.distance() == DistanceKind::Rows)
+        return column == 0;
+
+    return column <= columns_ - 1 - column;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+void ExactSolver<Row, Column, Policy>::prepare(const SeatingChart<Row, Column>& chart) {
+    size_    = chart.size();
+    rows_    = chart.rows();
+    columns_ = chart.columns();
+
+    assert(size_ <= MaxExactSeats && class_info.size() == size_);
+
+    const auto* inverse_distances = inverse_distances_of(chart, policy);
+
+    for (std::size_t first = 0; first < size_; first++)
+    {
+        for (std::size_t second = 0; second < size_; second++)
+        {
+            distance_weights[first][second]  = class_info.distance_weight(first, second);
+            tablemate_weights[first][second] = class_info.tablemate_weight(first, second);
+            closeness[first][second]         = inverse_distances[first * size_ + second];
+            shares_table[first][second] =
+              first != second && first / columns_ == second / columns_
+              && table_begin(policy, first % columns_) == table_begin(policy, second % columns_);
+        }
+    }
+
+    for (std::size_t seat = 0; seat < size_; seat++)
+    {
+        std::size_t others = 0;
+        table_places[seat] = 0;
+
+        for (std::size_t other = 0; other < size_; other++)
+        {
+            if (other == seat)
+                continue;
+
+            nearest[seat][others++] = closeness[seat][other];
+            table_places[seat] += shares_table[seat][other];
+        }
+
+        std::sort(nearest[seat].begin(), nearest[seat].begin() + others, std::greater{});
+        std::reverse_copy(nearest[seat].begin(), nearest[seat].begin() + others,
+                          farthest[seat].begin());
+    }
+
+    for (std::size_t student = 0; student < size_; student++)
+    {
+        relation_count[student]  = 0;
+        tablemate_count[student] = 0;
+
+        for (std::size_t other = 0; other < size_; other++)
+        {
+            if (other != student && distance_weights[student][other] != 0)
+                relations[student][relation_count[student]++] = {distance_weights[student][other],
+                                                                 other};
+
+            if (other != student && tablemate_weights[student][other] > 0)
+                tablemates[student][tablemate_count[student]++] = {
+                  tablemate_weights[student][other], other};
+        }
+
+        std::sort(relations[student].begin(), relations[student].begin() + relation_count[student],
+                  std::greater{});
+        std::sort(tablemates[student].begin(),
+                  tablemates[student].begin() + tablemate_count[student], std::greater{});
+    }
+
+    // Greedy order: the student with the most relations, then whoever has the most relations
+    // among those already ordered
+    std::array<bool, MaxExactSeats>        ordered{};
+    std::array<std::size_t, MaxExactSeats> links{};
+
+    related_count = 0;
+
+    for (std::size_t depth = 0; depth < size_; depth++)
+    {
+        std::size_t next = Unseated;
+
+        for (std::size_t student = 0; student < size_; student++)
+        {
+            if (ordered[student])
+                continue;
+
+            const auto degree      = class_info.neighbours_of(student).size();
+            const auto next_degree = next == Unseated ? 0 : class_info.neighbours_of(next).size();
+
+            if (next == Unseated || links[student] > links[next]
+                || (links[student] == links[next] && degree > next_degree))
+                next = student;
+        }
+
+        order[depth]   = next;
+        position[next] = depth;
+        ordered[next]  = true;
+
+        if (class_info.has_relationships(next))
+            related_count++;
+
+        for (const auto other : class_info.neighbours_of(next))
+            links[other]++;
+    }
+
+    unseated_halves.resize(size_ + 1);
+
+    for (std::size_t depth = 0; depth <= size_; depth++)
+        for (std::size_t later = depth; later < size_; later++)
+            for (std::size_t place = 0; place < size_; place++)
+                unseated_halves[depth][order[later]][place] =
+                  unseated_terms(depth, order[later], place) / 2;
+
+    symmetric = !class_info.constrained();
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+void ExactSolver<Row, Column, Policy>::reset(Worker& worker) const {
+    worker.seat_of.fill(Unseated);
+    worker.student_at.fill(Unseated);
+    worker.gains.resize(size_ + 1);
+
+    for (auto& row : worker.gains[0])
+        row.fill(0);
+}
+
+// Seats order[depth] and derives the gains of everyone after it
+template<std::size_t Row, std::size_t Column, typename Policy>
+void ExactSolver<Row, Column, Policy>::seat(Worker&     worker,
+                                            std::size_t depth,
+                                            std::size_t place) const {
+    const auto student = order[depth];
+
+    worker.seat_of[student]  = place;
+    worker.student_at[place] = student;
+
+    auto&       next    = worker.gains[depth + 1];
+    const auto& current = worker.gains[depth];
+
+    for (std::size_t later = depth + 1; later < size_; later++)
+        next[order[later]] = current[order[later]];
+
+    for (const auto other : class_info.neighbours_of(student))
+        if (worker.seat_of[other] == Unseated)
+            for (std::size_t other_seat = 0; other_seat < size_; other_seat++)
+                if (other_seat != place)
+                    next[other][other_seat] += term(other, student, other_seat, place);
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+void ExactSolver<Row, Column, Policy>::unseat(Worker& worker, std::size_t depth) const {
+    const auto student = order[depth];
+
+    worker.student_at[worker.seat_of[student]] = Unseated;
+    worker.seat_of[student]                    = Unseated;
+}
+
+// Upper bound on the terms of a student in `place` with the students still unseated at
+// `depth`. Pairing the largest weights with the nearest seats, the most negative with the
+// farthest, and the largest tablemate weights with the places at the table beats any seating.
+template<std::size_t Row, std::size_t Column, typename Policy>
+double ExactSolver<Row, Column, Policy>::unseated_terms(std::size_t depth,
+                                                        std::size_t student,
+                                                        std::size_t place) const noexcept {
+    const auto& weights = relations[student];
+    const auto  count   = relation_count[student];
+
+    double      total = 0;
+    std::size_t near = 0, far = 0, mates = 0;
+
+    for (std::size_t i = 0; i < count && weights[i].first > 0; i++)
+        if (position[weights[i].second] >= depth)
+            total += weights[i].first * nearest[place][near++];
+
+    for (std::size_t i = count; i-- > 0 && weights[i].first < 0;)
+        if (position[weights[i].second] >= depth)
+            total += weights[i].first * farthest[place][far++];
+
+    for (std::size_t i = 0; i < tablemate_count[student] && mates < table_places[place]; i++)
+        if (position[tablemates[student][i].second] >= depth)
+        {
+            total += tablemates[student][i].first;
+            mates++;
+        }
+
+    return total;
+}
+
+// Upper bound on any completion of a node `depth` students deep that has scored `score`. A
+// student in a free seat is worth what they gain there against the seated students and half
+// their bound against the unseated ones, who count the other half. Letting every unseated
+// student take their best seat gives a quick bound; when that cannot prune against `cutoff`,
+// the students are assigned distinct seats as well.
+template<std::size_t Row, std::size_t Column, typename Policy>
+double ExactSolver<Row, Column, Policy>::bound(Worker&     worker,
+                                               std::size_t depth,
+                                               double      score,
+                                               double      cutoff) const {
+    const auto& gains = worker.gains[depth];
+
+    std::array<std::size_t, MaxExactSeats> free_seats;
+    std::size_t                            free_count = 0;
+
+    for (std::size_t place = 0; place < size_; place++)
+        if (worker.student_at[place] == Unseated)
+            free_seats[free_count++] = place;
+
+    double total = score;
+
+    Values row_bests;
+
+    for (std::size_t later = depth; later < related_count; later++)
+    {
+        const auto student = order[later];
+        auto&      values  = worker.values[later - depth];
+        auto&      best    = row_bests[later - depth];
+
+        best = std::numeric_limits<double>::lowest();
+
+        for (std::size_t i = 0; i < free_count; i++)
+        {
+            const auto place = free_seats[i];
+
+            values[i] = class_info.may_sit(student, place)
+                        ? gains[student][place] + unseated_halves[depth][student][place]
+                        : -Unassignable;
+            best = std::max(best, values[i]);
+        }
+
+        total += best;
+    }
+
+    if (total <= cutoff || depth + 1 >= related_count)
+        return total;
+
+    return score
+         + assignment(worker.values, row_bests, related_count - depth, free_count, cutoff - score);
+}
+
+// Largest total of `values` over assignments of the first `rows` rows to distinct columns, by
+// the Hungarian method with shortest augmenting paths. Rows are added one at a time, and once
+// the best assignment of those added plus the best entries of the rest cannot exceed `limit`,
+// that sum is returned instead.
+template<std::size_t Row, std::size_t Column, typename Policy>
+double ExactSolver<Row, Column, Policy>::assignment(const Matrix& values,
+                                                    const Values& row_bests,
+                                                    std::size_t   rows,
+                                                    std::size_t   columns,
+                                                    double        limit) noexcept {
+    constexpr double Infinity = std::numeric_limits<double>::infinity();
+
+    // One-based, column 0 standing for the row being added
+    std::array<double, MaxExactSeats + 1>      row_potential{}, column_potential{}, slack;
+    std::array<std::size_t, MaxExactSeats + 1> row_of{}, previous;
+    std::array<bool, MaxExactSeats + 1>        visited;
+
+    double rest = 0;
+
+    for (std::size_t row = 0; row < rows; row++)
+        rest += row_bests[row];
+
+    for (std::size_t row = 1; row <= rows; row++)
+    {
+        rest -= row_bests[row - 1];
+
+        row_of[0]          = row;
+        std::size_t column = 0;
+
+        slack.fill(Infinity);
+        visited.fill(false);
+
+        do
+        {
+            visited[column] = true;
+
+            const auto  current = row_of[column];
+            double      delta   = Infinity;
+            std::size_t next    = 0;
+
+            for (std::size_t other = 1; other <= columns; other++)
+            {
+                if (visited[other])
+                    continue;
+
+                const auto reduced = -values[current - 1][other - 1] - row_potential[current]
+                                   - column_potential[other];
+
+                if (reduced < slack[other])
+                {
+                    slack[other]    = reduced;
+                    previous[other] = column;
+                }
+
+                if (slack[other] < delta)
+                {
+                    delta = slack[other];
+                    next  = other;
+                }
+            }
+
+            for (std::size_t other = 0; other <= columns; other++)
+            {
+                if (visited[other])
+                {
+                    row_potential[row_of[other]] += delta;
+                    column_potential[other] -= delta;
+                }
+                else
+                    slack[other] -= delta;
+            }
+
+            column = next;
+        } while (row_of[column] != 0);
+
+        while (column != 0)
+        {
+            const auto before = previous[column];
+            row_of[column]    = row_of[before];
+            column            = before;
+        }
+
+        // The potential of the extra column is minus the best total so far
+        if (row < rows && column_potential[0] + rest <= limit)
+            return column_potential[0] + rest;
+    }
+
+    double total = 0;
+
+    for (std::size_t column = 1; column <= columns; column++)
+        if (row_of[column] != 0)
+            total += values[row_of[column] - 1][column - 1];
+
+    return total;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+void ExactSolver<Row, Column, Policy>::record(Worker& worker, double score) {
+    double best = best_score_.load(std::memory_order_relaxed);
+
+    while (score > best + ScoreTolerance
+           && !best_score_.compare_exchange_weak(best, score, std::memory_order_relaxed))
+    {}
+
+    if (score > best + ScoreTolerance && score > worker.best_score)
+    {
+        worker.best_score      = score;
+        worker.best_student_at = worker.student_at;
+    }
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+void ExactSolver<Row, Column, Policy>::descend(Worker& worker, std::size_t depth, double score) {
+    if (out_of_time.load(std::memory_order_relaxed))
+        return;
+
+    if ((++worker.nodes & 0xFFF) == 0 && has_deadline
+        && std::chrono::steady_clock::now() >= deadline)
+    {
+        out_of_time.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    // Students without relationships score nothing anywhere, so any free seats will do
+    if (depth == related_count && !class_info.constrained())
+    {
+        auto place = std::size_t{0};
+
+        for (std::size_t later = depth; later < size_; later++)
+        {
+            while (worker.student_at[place] != Unseated)
+                place++;
+
+            worker.student_at[place] = order[later];
+        }
+
+        record(worker, score);
+
+        for (std::size_t later = depth; later < size_; later++)
+            worker.student_at[std::find(worker.student_at.begin(), worker.student_at.begin() + size_,
+                                        order[later])
+                              - worker.student_at.begin()] = Unseated;
+        return;
+    }
+
+    if (depth == size_)
+    {
+        record(worker, score);
+        return;
+    }
+
+    const auto student = order[depth];
+
+    // Best gain first, so good charts are found early and prune the rest
+    std::array<std::pair<double, std::size_t>, MaxExactSeats> candidates;
+    std::size_t                                               count = 0;
+
+    for (std::size_t place = 0; place < size_; place++)
+        if (may_seat(worker, student, place) && (depth > 0 || !symmetric || canonical(place)))
+            candidates[count++] = {worker.gains[depth][student][place], place};
+
+    std::sort(candidates.begin(), candidates.begin() + count,
+              [](const auto& first, const auto& second) { return first.first > second.first; });
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const auto [gain, place] = candidates[i];
+
+        seat(worker, depth, place);
+
+        const auto cutoff = best_score_.load(std::memory_order_relaxed) + ScoreTolerance;
+
+        if (bound(worker, depth + 1, score + gain, cutoff) > cutoff)
+            descend(worker, depth + 1, score + gain);
+
+        unseat(worker, depth);
+    }
+}
+
+// Every feasible way to seat the first SplitDepth students, best bound first
+template<std::size_t Row, std::size_t Column, typename Policy>
+auto ExactSolver<Row, Column, Policy>::split() -> std::vector<Task> {
+    std::vector<Task> tasks;
+    Worker            worker;
+    reset(worker);
+
+    const auto depth_limit = std::min(SplitDepth, size_);
+
+    const auto enumerate = [&](const auto& self, std::size_t depth, double score, Task task) -> void {
+        if (depth == depth_limit)
+        {
+            task.bound = bound(worker, depth, score, std::numeric_limits<double>::lowest());
+            tasks.push_back(task);
+            return;
+        }
+
+        const auto student = order[depth];
+
+        for (std::size_t place = 0; place < size_; place++)
+        {
+            if (!may_seat(worker, student, place) || (depth == 0 && symmetric && !canonical(place)))
+                continue;
+
+            const auto gain = worker.gains[depth][student][place];
+
+            seat(worker, depth, place);
+            task.seats[depth] = place;
+            self(self, depth + 1, score + gain, task);
+            unseat(worker, depth);
+        }
+    };
+
+    enumerate(enumerate, 0, 0.0, Task{});
+
+    std::sort(tasks.begin(), tasks.end(),
+              [](const Task& first, const Task& second) { return first.bound > second.bound; });
+
+    return tasks;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+ExactResult<Row, Column> ExactSolver<Row, Column, Policy>::solve(const SeatingChart<Row, Column>& start,
+                                                                 const ExactSettings& settings) {
+    assert(settings.threads > 0);
+
+    prepare(start);
+
+    ChartScorer<Row, Column, Policy> scorer{class_info, policy};
+    SeatingChart<Row, Column>        incumbent{start};
+    SeatingChart<Row, Column>        chart{start};
+    Xoshiro256                       rng{settings.seed};
+
+    while (incumbent.hill_climb_combined(scorer))
+        count(StatCounter::ClimbSteps);
+
+    for (std::size_t restart = 0; restart < WarmStartRestarts; restart++)
+    {
+        count(StatCounter::Restarts);
+        chart.random_shuffle(rng, scorer);
+
+        while (chart.hill_climb_combined(scorer))
+            count(StatCounter::ClimbSteps);
+
+        if (scorer(chart) > scorer(incumbent) + ScoreTolerance)
+            incumbent = chart;
+    }
+
+    best_score_.store(scorer(incumbent));
+    out_of_time.store(false);
+    has_deadline = settings.seconds > 0;
+    deadline     = std::chrono::steady_clock::now()
+             + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                 std::chrono::duration<double>(settings.seconds));
+
+    const auto              tasks = split();
+    std::atomic<std::size_t> next_task{0};
+    std::vector<Worker>      workers(settings.threads);
+
+    const auto work = [&](Worker& worker) {
+        reset(worker);
+
+        for (auto task = next_task.fetch_add(1); task < tasks.size(); task = next_task.fetch_add(1))
+        {
+            if (tasks[task].bound <= best_score_.load(std::memory_order_relaxed) + ScoreTolerance)
+                continue;
+
+            double     score       = 0;
+            const auto depth_limit = std::min(SplitDepth, size_);
+
+            for (std::size_t depth = 0; depth < depth_limit; depth++)
+            {
+                score += worker.gains[depth][order[depth]][tasks[task].seats[depth]];
+                seat(worker, depth, tasks[task].seats[depth]);
+            }
+
+            descend(worker, depth_limit, score);
+
+            for (std::size_t depth = depth_limit; depth-- > 0;)
+                unseat(worker, depth);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(settings.threads - 1);
+
+    for (std::size_t i = 1; i < settings.threads; i++)
+        threads.emplace_back(work, std::ref(workers[i]));
+
+    work(workers[0]);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    std::size_t nodes = tasks.size();
+    const auto* best  = static_cast<const Worker*>(nullptr);
+
+    for (const auto& worker : workers)
+    {
+        nodes += worker.nodes;
+
+        if (worker.best_score > std::numeric_limits<double>::lowest()
+            && (!best || worker.best_score > best->best_score))
+            best = &worker;
+    }
+
+    if (best && best->best_score > scorer(incumbent) + ScoreTolerance)
+    {
+        auto seats = make_fixed_or_dynamic<Row>(
+          rows_, make_fixed_or_dynamic<Column, std::size_t>(columns_));
+
+        for (std::size_t place = 0; place < size_; place++)
+            seats[place / columns_][place % columns_] = best->best_student_at[place];
+
+        incumbent = SeatingChart<Row, Column>{std::move(seats)};
+    }
+
+    return {incumbent, scorer(incumbent), !out_of_time.load(), nodes};
+}
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#include "export.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace SeatingChartGenetic {
+
+bool write_file(const char* path, std::string_view text) {
+    std::array<char, 4096> temporary;
+
+    if (std::snprintf(temporary.data(), temporary.size(), "%s.tmp", path)
+        >= static_cast<int>(temporary.size()))
+        return false;
+
+    const int descriptor = ::open(temporary.data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (descriptor < 0)
+        return false;
+
+    while (!text.empty())
+    {
+        const auto written = ::write(descriptor, text.data(), text.size());
+
+        if (written < 0 && errno == EINTR)
+            continue;
+
+        if (written <= 0)
+            break;
+
+        text.remove_prefix(static_cast<std::size_t>(written));
+    }
+
+    if (::close(descriptor) != 0 || !text.empty())
+    {
+        std::remove(temporary.data());
+        return false;
+    }
+
+    return std::rename(temporary.data(), path) == 0;
+}
+
+}
@@ -1,29 +1,80 @@
 #ifndef EXPORT_HPP_INCLUDED
 #define EXPORT_HPP_INCLUDED
 
-#include <fstream>
+#include <array>
+#include <cstddef>
+#include <cstdio>
 #include <string>
+#include <string_view>
 
 #include "seatingchart.hpp"
 
 namespace SeatingChartGenetic {
 
+// Replaces the file with `text` by writing a temporary file renamed over the path, so readers
+// and a crash mid-write never see a partial chart.
+[[nodiscard]] bool write_file(const char*, std::string_view);
+
+// Writes charts as one name per line, by default to "<score>_<iteration>.txt". The text is
+// assembled in a buffer kept between charts and written at once, so exporting does not flush
+// per line and, after the first chart, does not allocate.
 template<std::size_t Row, std::size_t Column>
-void export_chart(const SeatingChart<Row, Column>&,
-                  const std::array<std::string, Row * Column>&,
-                  std::ofstream&&);
+class ChartExporter {
+    const FixedOrDynamic<Row * Column, std::string>& names;
+    std::string                                      text;
+
+    // Wide enough for any double printed with %f
+    std::array<char, 384> path;
+
+   public:
+    explicit ChartExporter(const FixedOrDynamic<Row * Column, std::string>&);
+
+    [[nodiscard]] bool export_chart(const SeatingChart<Row, Column>&, const char*);
+    [[nodiscard]] bool export_chart(const SeatingChart<Row, Column>&, double, std::size_t);
+};
 
 }
 
 namespace SeatingChartGenetic {
 
 template<std::size_t Row, std::size_t Column>
-void export_chart(const SeatingChart<Row, Column>&             chart,
-                  const std::array<std::string, Row * Column>& names,
-                  std::ofstream&&                              file) {
+ChartExporter<Row, Column>::ChartExporter(
+  const FixedOrDynamic<Row * Column, std::string>& lookup_name) :
+    names{lookup_name},
+    path{} {
+    std::size_t length = 0;
+
+    for (const auto& name : names)
+        length += name.size() + 1;
+
+    text.reserve(length);
+}
+
+template<std::size_t Row, std::size_t Column>
+bool ChartExporter<Row, Column>::export_chart(const SeatingChart<Row, Column>& chart,
+                                              const char*                      file) {
+    text.clear();
+
     for (const auto& row : chart.seats())
+    {
         for (const auto element : row)
-            file << names[element] << std::endl;
+        {
+            text += names[element];
+            text += '\n';
+        }
+    }
+
+    return write_file(file, text);
+}
+
+template<std::size_t Row, std::size_t Column>
+bool ChartExporter<Row, Column>::export_chart(const SeatingChart<Row, Column>& chart,
+                                              double                           score,
+                                              std::size_t                      iteration) {
+    // The same name std::to_string(score) + "_" + std::to_string(iteration) + ".txt" gives
+    std::snprintf(path.data(), path.size(), "%f_%zu.txt", score, iteration);
+
+    return export_chart(chart, path.data());
 }
 
 }
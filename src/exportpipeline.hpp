@@ -0,0 +1,324 @@
+#ifndef EXPORTPIPELINE_HPP_INCLUDED
+#define EXPORTPIPELINE_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "export.hpp"
+#include "seatingchart.hpp"
+
+namespace SeatingChartGenetic {
+
+enum class ExportMode {
+    // "<score>_<iteration>.txt" for every new best chart
+    Every,
+    // best.txt, replaced by every new best chart
+    Best,
+    // top_1.txt .. top_K.txt, the K best distinct charts seen, best first
+    Top,
+    // rolling.txt, replaced by the best chart at most once per interval
+    Rolling
+};
+
+struct ExportSettings {
+    ExportMode  mode;
+    std::size_t top;
+    double      interval_seconds;
+};
+
+// Exports charts on a background thread. Searches hand charts over through a bounded queue of
+// preallocated slots: submitting copies the chart under a short lock and never waits for the
+// disk. When the queue is full, a chart replaces the worst queued one if it scores higher and
+// is dropped otherwise. Every file is written through a temporary file renamed over it.
+template<std::size_t Row, std::size_t Column>
+class ExportPipeline {
+   public:
+    // Called on the export thread for every new best chart, after its files are written
+    using BestCallback = std::function<void(double, std::size_t, const SeatingChart<Row, Column>&)>;
+
+   private:
+    struct Entry {
+        double                    score;
+        std::size_t               iteration;
+        SeatingChart<Row, Column> chart;
+    };
+
+    const ExportSettings       settings;
+    ChartExporter<Row, Column> exporter;
+    BestCallback               on_best;
+
+    // Scores at or below this cannot change the exports, so searches need not submit them
+    std::atomic<double> threshold_;
+
+    std::mutex              mutex;
+    std::condition_variable ready;
+    std::vector<Entry>      queue;
+    std::size_t             queued   = 0;
+    bool                    stopping = false;
+
+    // Owned by the export thread
+    std::vector<Entry>   pending;
+    Entry                best;
+    bool                 rolling_dirty = false;
+    std::vector<Entry>   top;
+    std::size_t          top_count = 0;
+    std::array<char, 64> path;
+
+    std::thread thread;
+
+    void run();
+    void accept(const Entry&);
+    void insert_top(const Entry&);
+    void write_rolling();
+    void raise_threshold(double) noexcept;
+
+   public:
+    ExportPipeline(const SeatingChart<Row, Column>&,
+                   double,
+                   const FixedOrDynamic<Row * Column, std::string>&,
+                   ExportSettings,
+                   std::size_t,
+                   BestCallback);
+    ~ExportPipeline();
+
+    ExportPipeline(const ExportPipeline&)            = delete;
+    ExportPipeline& operator=(const ExportPipeline&) = delete;
+
+    [[nodiscard]] bool admits(double score) const noexcept {
+        return score > threshold_.load(std::memory_order_relaxed);
+    }
+
+    void submit(double, std::size_t, const SeatingChart<Row, Column>&);
+
+    // Exports everything submitted so far and stops the thread
+    void finish();
+};
+
+}
+
+namespace SeatingChartGenetic {
+
+// `seed` only sizes the preallocated slots. Charts must beat `seed_score` to count as a new
+// best, so a search resumed from a checkpoint passes the checkpoint's score; the top-K files
+// take any chart.
+template<std::size_t Row, std::size_t Column>
+ExportPipeline<Row, Column>::ExportPipeline(
+  const SeatingChart<Row, Column>&                 seed,
+  double                                           seed_score,
+  const FixedOrDynamic<Row * Column, std::string>& names,
+  ExportSettings                                   export_settings,
+  std::size_t                                      capacity,
+  BestCallback                                     callback) :
+    settings{export_settings},
+    exporter{names},
+    on_best{std::move(callback)},
+    threshold_{export_settings.mode == ExportMode::Top ? std::numeric_limits<double>::lowest()
+                                                       : seed_score},
+    queue(std::max<std::size_t>(capacity, 1), Entry{0, 0, seed}),
+    pending(queue),
+    best{seed_score, 0, seed},
+    top(export_settings.mode == ExportMode::Top ? std::max<std::size_t>(export_settings.top, 1)
+                                                 : 0,
+        Entry{0, 0, seed}),
+    path{},
+    thread{&ExportPipeline::run, this} {}
+
+template<std::size_t Row, std::size_t Column>
+ExportPipeline<Row, Column>::~ExportPipeline() {
+    finish();
+}
+
+// Searches may submit a chart that another thread has already beaten, so the threshold is only
+// ever raised; storing such a score would let worse charts through again
+template<std::size_t Row, std::size_t Column>
+void ExportPipeline<Row, Column>::raise_threshold(double score) noexcept {
+    double current = threshold_.load(std::memory_order_relaxed);
+
+    while (score > current
+           && !threshold_.compare_exchange_weak(current, score, std::memory_order_relaxed))
+    {}
+}
+
+template<std::size_t Row, std::size_t Column>
+void ExportPipeline<Row, Column>::submit(double                           score,
+                                         std::size_t                      iteration,
+                                         const SeatingChart<Row, Column>& chart) {
+    {
+        std::lock_guard lock{mutex};
+
+        auto* slot = queued < queue.size() ? &queue[queued] : nullptr;
+
+        if (!slot)
+        {
+            auto* worst = &*std::min_element(
+              queue.begin(), queue.end(),
+              [](const Entry& first, const Entry& second) { return first.score < second.score; });
+
+            if (worst->score >= score)
+                return;
+
+            slot = worst;
+        }
+        else
+            queued++;
+
+        slot->score     = score;
+        slot->iteration = iteration;
+        slot->chart     = chart;
+
+        // Only a better chart can be a new best; top-K raises its bar on the export thread
+        if (settings.mode != ExportMode::Top)
+            raise_threshold(score);
+    }
+
+    ready.notify_one();
+}
+
+template<std::size_t Row, std::size_t Column>
+void ExportPipeline<Row, Column>::finish() {
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+    }
+
+    ready.notify_all();
+
+    if (thread.joinable())
+        thread.join();
+}
+
+template<std::size_t Row, std::size_t Column>
+void ExportPipeline<Row, Column>::run() {
+    using Clock = std::chrono::steady_clock;
+
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(settings.interval_seconds));
+    auto next_rolling = Clock::now() + interval;
+
+    std::unique_lock lock{mutex};
+
+    while (true)
+    {
+        const auto has_work = [&] { return queued > 0 || stopping; };
+
+        if (settings.mode == ExportMode::Rolling)
+            ready.wait_until(lock, next_rolling, has_work);
+        else
+            ready.wait(lock, has_work);
+
+        const auto count = queued;
+        const bool last  = stopping && queued == 0;
+
+        for (std::size_t i = 0; i < count; i++)
+            std::swap(pending[i], queue[i]);
+
+        queued = 0;
+        lock.unlock();
+
+        std::sort(pending.begin(), pending.begin() + count,
+                  [](const Entry& first, const Entry& second) { return first.score < second.score; });
+
+        for (std::size_t i = 0; i < count; i++)
+            accept(pending[i]);
+
+        if (settings.mode == ExportMode::Rolling && (last || Clock::now() >= next_rolling))
+        {
+            write_rolling();
+            next_rolling = Clock::now() + interval;
+        }
+
+        if (last)
+            return;
+
+        lock.lock();
+    }
+}
+
+template<std::size_t Row, std::size_t Column>
+void ExportPipeline<Row, Column>::accept(const Entry& entry) {
+    if (settings.mode == ExportMode::Top)
+        insert_top(entry);
+
+    if (entry.score <= best.score)
+        return;
+
+    best.score     = entry.score;
+    best.iteration = entry.iteration;
+    best.chart     = entry.chart;
+
+    bool written = true;
+
+    if (settings.mode == ExportMode::Every)
+        written = exporter.export_chart(best.chart, best.score, best.iteration);
+    else if (settings.mode == ExportMode::Best)
+        written = exporter.export_chart(best.chart, "best.txt");
+    else if (settings.mode == ExportMode::Rolling)
+        rolling_dirty = true;
+
+    if (!written)
+        std::cerr << "Cannot write chart for score " << best.score << std::endl;
+
+    if (on_best)
+        on_best(best.score, best.iteration, best.chart);
+}
+
+// Keeps the K best distinct charts in descending order and rewrites the files from the
+// inserted rank down, as every lower rank shifts by one.
+template<std::size_t Row, std::size_t Column>
+void ExportPipeline<Row, Column>::insert_top(const Entry& entry) {
+    if (top_count == top.size() && entry.score <= top.back().score)
+        return;
+
+    for (std::size_t i = 0; i < top_count; i++)
+        if (top[i].score == entry.score && top[i].chart.seats() == entry.chart.seats())
+            return;
+
+    auto position = std::min(top_count, top.size() - 1);
+
+    for (; position > 0 && top[position - 1].score < entry.score; position--)
+        std::swap(top[position], top[position - 1]);
+
+    top[position].score     = entry.score;
+    top[position].iteration = entry.iteration;
+    top[position].chart     = entry.chart;
+    top_count               = std::min(top_count + 1, top.size());
+
+    if (top_count == top.size())
+        raise_threshold(top.back().score);
+
+    for (std::size_t rank = position; rank < top_count; rank++)
+    {
+        std::snprintf(path.data(), path.size(), "top_%zu.txt", rank + 1);
+
+        if (!exporter.export_chart(top[rank].chart, path.data()))
+            std::cerr << "Cannot write " << path.data() << std::endl;
+    }
+}
+
+template<std::size_t Row, std::size_t Column>
+void ExportPipeline<Row, Column>::write_rolling() {
+    if (!rolling_dirty)
+        return;
+
+    if (!exporter.export_chart(best.chart, "rolling.txt"))
+        std::cerr << "Cannot write rolling.txt" << std::endl;
+
+    rolling_dirty = false;
+}
+
+}
+
+#endif
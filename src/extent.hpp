@@ -0,0 +1,38 @@
+#ifndef EXTENT_HPP_INCLUDED
+#define EXTENT_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace SeatingChartGenetic {
+
+// Size parameter meaning "known only at runtime". SeatingChart<Dynamic, Dynamic> and
+// ClassInfo<Dynamic> share their code with the fixed-size versions and swap std::array
+// storage for std::vector.
+inline constexpr std::size_t Dynamic = 0;
+
+template<std::size_t Size, typename T>
+using FixedOrDynamic = std::conditional_t<Size == Dynamic, std::vector<T>, std::array<T, Size>>;
+
+template<std::size_t Size>
+inline constexpr std::size_t SpanExtent = Size == Dynamic ? std::dynamic_extent : Size;
+
+template<std::size_t Size, typename T>
+[[nodiscard]] constexpr FixedOrDynamic<Size, T> make_fixed_or_dynamic(std::size_t size,
+                                                                      const T&    value = T{}) {
+    if constexpr (Size == Dynamic)
+        return FixedOrDynamic<Size, T>(size, value);
+    else
+    {
+        FixedOrDynamic<Size, T> result;
+        result.fill(value);
+        return result;
+    }
+}
+
+}
+
+#endif
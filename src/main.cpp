@@ -1,64 +1,828 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <charconv>
 #include <cmath>
-#include <fstream>
+#include <cstdint>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <optional>
 #include <random>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
-#include "export.hpp"
+#include "batch.hpp"
+#include "dispatch.hpp"
+#include "exactsolver.hpp"
+#include "exportpipeline.hpp"
+#include "mappedfile.hpp"
+#include "migration.hpp"
+#include "parallelsearch.hpp"
 #include "parse.hpp"
-#include "seatingchart.hpp"
+#include "reseat.hpp"
+#include "service.hpp"
 #include "simulation.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
+
+#include <sys/stat.h>
 
 using namespace SeatingChartGenetic;
 
-int main() {
-    constexpr std::size_t Row      = 6;
-    constexpr std::size_t Column   = 8;
-    constexpr std::size_t Patience = 1500;
+namespace {
 
-    auto [names_lookup, seating_chart, class_info] =
-      parse<Row, Column>(std::ifstream("6_by_8.txt"));
+template<typename T>
+bool parse_number(std::string_view text, T& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
 
-    std::cout << "Patience: " << Patience << std::endl;
+bool parse_export_mode(std::string_view text, ExportMode& mode) {
+    for (const auto& [name, value] : {std::pair{"every", ExportMode::Every},
+                                      std::pair{"best", ExportMode::Best},
+                                      std::pair{"top", ExportMode::Top},
+                                      std::pair{"rolling", ExportMode::Rolling}})
+    {
+        if (text == name)
+        {
+            mode = value;
+            return true;
+        }
+    }
 
+    return false;
+}
 
-    auto scoring_function = [&class_info = class_info](const SeatingChart<Row, Column>& chart) {
-        return score_chart(chart, class_info);
-    };
+bool parse_distance_kind(std::string_view text, DistanceKind& kind) {
+    for (const auto& [name, value] : {std::pair{"euclidean", DistanceKind::Euclidean},
+                                      std::pair{"manhattan", DistanceKind::Manhattan},
+                                      std::pair{"rows", DistanceKind::Rows}})
+    {
+        if (text == name)
+        {
+            kind = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// "TABLEMATE,FRIEND,ENEMY"
+bool parse_weights(std::string_view text, ScoreWeights& weights) {
+    ScoreWeights parsed;
+
+    for (auto* value : {&parsed.tablemate, &parsed.friends, &parsed.enemies})
+    {
+        const auto end = text.find(',');
+
+        if (!parse_number(text.substr(0, end), *value))
+            return false;
+
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    }
+
+    if (!text.empty())
+        return false;
+
+    weights = parsed;
+    return true;
+}
+
+// The input is either a text roster or a binary snapshot, such as a checkpoint to resume.
+// Reads the room size from whichever it is, or says why it cannot.
+bool read_room_size(const MappedFile& file,
+                    SnapshotView&     snapshot,
+                    std::size_t&      rows,
+                    std::size_t&      columns,
+                    std::string&      error) {
+    if (!file.is_open())
+    {
+        error = "cannot open the file";
+        return false;
+    }
+
+    if (is_snapshot(file.view()))
+    {
+        if (!open_snapshot(file.view(), snapshot, error))
+            return false;
+
+        rows    = snapshot.rows;
+        columns = snapshot.columns;
+        return true;
+    }
+
+    std::string_view header = file.view();
+
+    if (!parse_room_size(header, rows, columns))
+    {
+        error = "cannot read the room size";
+        return false;
+    }
+
+    return true;
+}
+
+// Rows must hold whole tables of the scoring's layout
+bool check_tables(const RuntimeScoring& scoring, std::size_t columns, std::string& error) {
+    if (fits_tables(scoring, columns))
+        return true;
+
+    error = std::to_string(columns) + " columns do not divide into tables of "
+          + std::to_string(scoring.table_seats());
+    return false;
+}
+
+// On a parse error, `error` is "LINE: MESSAGE"
+template<std::size_t Row, std::size_t Column>
+std::optional<ParseResult<Row, Column>> load_class(const MappedFile&   file,
+                                                   const SnapshotView& snapshot,
+                                                   std::string&        error) {
+    if (is_snapshot(file.view()))
+        return load_snapshot<Row, Column>(snapshot);
+
+    ParseError parse_error;
+    auto       parsed = parse<Row, Column>(file.view(), parse_error);
+
+    if (!parsed)
+        error = std::to_string(parse_error.line) + ": " + parse_error.message;
+
+    return parsed;
+}
+
+// Island-model search: this process listens on `listen` and exchanges best charts with the
+// islands at `peers` every `interval` generations or restarts. Islands need not run the same
+// strategy, but must search the same class.
+struct IslandSettings {
+    std::string              listen;
+    std::vector<std::string> peers;
+    std::size_t              interval = 100;
+};
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+void run_genetic(const ParseResult<Row, Column>& parsed,
+                 std::size_t                     population,
+                 const SearchConfig&             config,
+                 const Policy&                   policy,
+                 MigrationChannel*               channel,
+                 std::size_t                     interval) {
+    Simulation<Row, Column, Policy> simulation{parsed.chart,    parsed.class_info, population,
+                                               config.threads, config.seed,       policy};
+
+    std::optional<Migration<Row, Column, Policy>> migration;
+    SeatingChart<Row, Column>                     migrant{parsed.chart};
+    double                                        migrant_score;
+
+    if (channel)
+        migration.emplace(*channel, parsed.class_info, policy);
+
+    const StopToken stop{deadline_after(config.seconds)};
+    ScoreTrace      trace;
+    double          best_score = std::numeric_limits<double>::lowest();
+    std::size_t     generation = 0;
+
+    // The first population is random, so any score is an improvement over nothing
+    ExportPipeline<Row, Column> pipeline{
+      parsed.chart, std::numeric_limits<double>::lowest(), parsed.lookup_name, config.exports, 2,
+      [&](double score, std::size_t, const SeatingChart<Row, Column>& best) {
+          if (!config.checkpoint.empty()
+              && !save_snapshot(config.checkpoint, parsed.lookup_name, best, parsed.class_info))
+              std::cerr << "Cannot write checkpoint " << config.checkpoint << std::endl;
+
+          std::cout << "New High: " << score << std::endl;
+      }};
+
+    // The deadline is only checked between generations, so the search may overrun it by up
+    // to one full generation: scoring and breeding the whole population across the pool
+    for (; !stop.stop_requested(); generation++)
+    {
+        const auto [curr_value] = simulation.step();
+
+        if (curr_value > best_score)
+        {
+            best_score = curr_value;
+            trace.record(curr_value, generation);
+        }
+
+        if (pipeline.admits(curr_value))
+            pipeline.submit(curr_value, generation, simulation.top().chart);
+
+        if (migration && (generation + 1) % interval == 0)
+        {
+            migration->emigrate(simulation.top().chart);
+
+            if (migration->immigrate(migrant, migrant_score))
+                simulation.immigrate(migrant);
+        }
+    }
+
+    pipeline.finish();
+
+    std::cout << "Best: " << best_score << " after " << generation << " generations" << std::endl;
+
+    if (!config.trace.empty() && !write_file(config.trace.c_str(), trace.tsv("generation")))
+        std::cerr << "Cannot write trace " << config.trace << std::endl;
+}
+
+// The workers never see the channel: a thread polls the restart count and, every `interval`
+// restarts, sends the best chart and hands the best migrant to one worker
+template<std::size_t Row, std::size_t Column, typename Policy>
+void run_search(const ParseResult<Row, Column>& parsed,
+                const SearchConfig&             config,
+                const Policy&                   policy,
+                MigrationChannel*               channel,
+                std::size_t                     interval) {
+    constexpr auto MigrationPoll = std::chrono::milliseconds{10};
+
+    ParallelSearch<Row, Column, Policy> search{parsed.chart, parsed.class_info, parsed.lookup_name,
+                                               config, policy};
+
+    if (!channel)
+    {
+        search.run();
+        return;
+    }
+
+    std::atomic<bool> done{false};
+
+    std::thread migrator{[&] {
+        Migration<Row, Column, Policy> migration{*channel, parsed.class_info, policy};
+        SeatingChart<Row, Column>      migrant{parsed.chart};
+        double                         migrant_score;
+
+        for (auto next = interval; !done.load(); std::this_thread::sleep_for(MigrationPoll))
+        {
+            if (search.restarts() < next)
+                continue;
+
+            next = search.restarts() + interval;
+            migration.emigrate(search.best_chart());
+
+            if (migration.immigrate(migrant, migrant_score))
+                search.immigrate(migrant);
+        }
+    }};
+
+    search.run();
+    done.store(true);
+    migrator.join();
+}
+
+// Exports the best chart once, as the first new best of a search would be
+template<std::size_t Row, std::size_t Column, typename Policy>
+void run_exact(const ParseResult<Row, Column>& parsed,
+               const SearchConfig&             config,
+               double                          seconds,
+               const Policy&                   policy) {
+    ExactSolver<Row, Column, Policy> solver{parsed.class_info, policy};
+
+    const auto start  = std::chrono::steady_clock::now();
+    const auto result = solver.solve(parsed.chart, {config.threads, seconds, config.seed});
+    const auto elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (result.optimal)
+        std::cout << "Optimal: " << result.score << std::endl;
+    else
+        std::cout << "Best (not proven optimal): " << result.score << std::endl;
+
+    std::cout << "Nodes: " << result.nodes << " in " << elapsed << "s" << std::endl;
+
+    ExportPipeline<Row, Column> pipeline{parsed.chart, std::numeric_limits<double>::lowest(),
+                                         parsed.lookup_name, config.exports, 1, {}};
+    pipeline.submit(result.score, 0, result.chart);
+    pipeline.finish();
+
+    if (!config.checkpoint.empty()
+        && !save_snapshot(config.checkpoint, parsed.lookup_name, result.chart, parsed.class_info))
+        std::cerr << "Cannot write checkpoint " << config.checkpoint << std::endl;
+}
+
+// Applies the edits in `edits_text` to the class and re-seats around them, starting from the
+// chart as given, normally the checkpoint of an earlier run. Exports the chart once, as
+// run_exact does.
+template<std::size_t Row, std::size_t Column, typename Policy>
+int run_reseat(ParseResult<Row, Column>& parsed,
+               std::string_view          edits_path,
+               std::string_view          edits_text,
+               std::size_t               radius,
+               const SearchConfig&       config,
+               const Policy&             policy) {
+    ClassEditor<Row * Column> editor{parsed.class_info};
+    ParseError                error;
+
+    if (!parse_edits(edits_text, parsed.lookup_name, editor, error))
+    {
+        std::cerr << edits_path << ":" << error.line << ": " << error.message << std::endl;
+        return 1;
+    }
+
+    const auto   start        = std::chrono::steady_clock::now();
+    const double before_score = score_chart(parsed.chart, parsed.class_info, policy);
+    const auto   pairs        = editor.edited_pairs();
+    auto         edited       = editor.build();
+    const double edited_score =
+      before_score + edit_score_delta(parsed.chart, parsed.class_info, edited, pairs, policy);
+
+    parsed.class_info = std::move(edited);
+
+    ChartScorer<Row, Column, Policy> scorer{parsed.class_info, policy};
+
+    const auto result  = reseat(parsed.chart, scorer, parsed.class_info, pairs, edited_score, radius);
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()
+                                                                   - start)
+                           .count();
+
+    assert(std::abs(result.score - scorer(parsed.chart)) < 1e-6);
+
+    std::cout << "Before edits: " << before_score << std::endl;
+    std::cout << "After edits: " << edited_score << std::endl;
+    std::cout << "Reseated: " << result.score << " in " << result.moves << " moves around "
+              << result.reach << " students, " << elapsed << "ms" << std::endl;
+
+    ExportPipeline<Row, Column> pipeline{parsed.chart, std::numeric_limits<double>::lowest(),
+                                         parsed.lookup_name, config.exports, 1, {}};
+    pipeline.submit(result.score, 0, parsed.chart);
+    pipeline.finish();
+
+    if (!config.checkpoint.empty()
+        && !save_snapshot(config.checkpoint, parsed.lookup_name, parsed.chart, parsed.class_info))
+    {
+        std::cerr << "Cannot write checkpoint " << config.checkpoint << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// Chart of `input` in `directory`, named after the input's file name without extension
+std::string batch_output_path(const std::string& directory, std::string_view input) {
+    if (const auto slash = input.rfind('/'); slash != std::string_view::npos)
+        input.remove_prefix(slash + 1);
+
+    if (const auto dot = input.rfind('.'); dot != std::string_view::npos && dot > 0)
+        input = input.substr(0, dot);
+
+    return directory + "/" + std::string{input};
+}
+
+// Searches every class listed in `manifest_path` and writes each best chart, and a
+// summary.tsv of them all, to `directory`. A class that cannot be loaded is reported in the
+// summary and fails the batch, but the others are still searched.
+int run_batch_mode(std::string_view                   manifest_path,
+                   const std::string&                 directory,
+                   const SearchConfig&                config,
+                   const RuntimeScoring&              scoring,
+                   bool                               runtime_scoring,
+                   const std::optional<ScoreWeights>& weights) {
+    const MappedFile manifest{manifest_path.data()};
+
+    if (!manifest.is_open())
+    {
+        std::cerr << "Cannot open " << manifest_path << std::endl;
+        return 1;
+    }
+
+    std::vector<BatchEntry> entries;
+    ParseError              manifest_error;
+
+    if (!parse_manifest(manifest.view(), entries, manifest_error))
+    {
+        std::cerr << manifest_path << ":" << manifest_error.line << ": " << manifest_error.message
+                  << std::endl;
+        return 1;
+    }
+
+    if (::mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST)
+    {
+        std::cerr << "Cannot create " << directory << std::endl;
+        return 1;
+    }
+
+    // Inputs sharing a file name in different directories get numbered charts
+    std::map<std::string, std::size_t> outputs;
+    std::vector<BatchJob>              jobs;
+
+    for (const auto& entry : entries)
+    {
+        auto output = batch_output_path(directory, entry.input);
+
+        if (const auto uses = outputs[output]++; uses > 0)
+            output += "-" + std::to_string(uses + 1);
+
+        output += ".chart.txt";
+
+        const MappedFile file{entry.input.c_str()};
+        SnapshotView     snapshot;
+        std::size_t      rows, columns;
+        std::string      error;
+
+        if (!read_room_size(file, snapshot, rows, columns, error)
+            || !check_tables(scoring, columns, error))
+        {
+            jobs.push_back(failed_batch_job(error));
+            continue;
+        }
+
+        jobs.push_back(dispatch_size(rows, columns, [&]<std::size_t Row, std::size_t Column>() {
+            auto parsed = load_class<Row, Column>(file, snapshot, error);
 
-    std::default_random_engine rng{std::random_device{}()};
-    double                     best_value                  = -1000;
-    std::size_t                iterations_since_last_raise = 0;
+            if (!parsed)
+                return failed_batch_job("line " + error);
 
-    for (std::size_t i = 0; i < std::numeric_limits<std::size_t>::max(); i++)
+            if (weights)
+                parsed->class_info.set_weights(*weights);
+
+            return dispatch_scoring(scoring, runtime_scoring, [&](const auto& policy) {
+                if (!parsed->chart.seat_feasibly(parsed->class_info, policy))
+                    return failed_batch_job("the seat rules cannot all be met");
+
+                return make_batch_job<Row, Column>(std::move(*parsed), entry, config, policy,
+                                                   output);
+            });
+        }));
+    }
+
+    std::cout << "Classes: " << jobs.size() << std::endl;
+    std::cout << "Threads: " << config.threads << std::endl;
+    std::cout << "Seed: " << config.seed << std::endl;
+
+    const auto outcomes = run_batch(jobs, config.threads);
+
+    std::ostringstream summary;
+    summary << "input\tscore\trestarts\tseconds\tstatus\n";
+
+    std::size_t failed = 0, on_target = 0;
+
+    for (std::size_t i = 0; i < entries.size(); i++)
     {
-        seating_chart.partial_random_shuffle<decltype(rng), 12>(rng);
-        iterations_since_last_raise++;
+        const auto& outcome = outcomes[i];
+        const auto& entry   = entries[i];
+
+        summary << entry.input << '\t';
 
-        while (seating_chart.hill_climb_combined(scoring_function))
-        {}
+        if (!outcome.error.empty())
+        {
+            summary << "\t\t\terror: " << outcome.error << '\n';
+            failed++;
+            continue;
+        }
 
-        const double curr_value = score_chart(seating_chart, class_info);
+        summary << outcome.score << '\t' << outcome.restarts << '\t' << outcome.seconds << '\t';
 
-        if (curr_value > best_value)
+        if (outcome.reached_target)
         {
-            export_chart(
-              seating_chart, names_lookup,
-              std::ofstream(std::to_string(curr_value) + "_" + std::to_string(i) + ".txt"));
+            summary << "target\n";
+            on_target++;
+        }
+        else if (entry.target)
+            summary << "missed target\n";
+        else
+            summary << "budget\n";
+    }
 
-            std::cout << "New High: " << curr_value << std::endl;
+    std::cout << summary.str();
+    std::cout << "Searched: " << entries.size() - failed << ", reached target: " << on_target
+              << ", failed: " << failed << std::endl;
 
-            best_value                  = curr_value;
-            iterations_since_last_raise = 0;
+    if (const auto path = directory + "/summary.tsv"; !write_file(path.c_str(), summary.str()))
+    {
+        std::cerr << "Cannot write " << path << std::endl;
+        return 1;
+    }
+
+    return failed == 0 ? 0 : 1;
+}
+
+// Serves classes as JSON lines on stdin and stdout until stdin ends; see service.hpp
+int run_service_mode(const SearchConfig&                config,
+                     std::size_t                        max_jobs,
+                     const RuntimeScoring&              scoring,
+                     bool                               runtime_scoring,
+                     const std::optional<ScoreWeights>& weights) {
+    const auto factory = [&](std::string_view roster, const JobLimits& limits,
+                             ImprovementSink on_improved,
+                             std::string&    error) -> std::shared_ptr<ServiceJob> {
+        std::string_view header = roster;
+        std::size_t      rows, columns;
+
+        if (!parse_room_size(header, rows, columns))
+        {
+            error = "cannot read the room size";
+            return nullptr;
         }
 
-        if (iterations_since_last_raise > Patience)
+        if (!check_tables(scoring, columns, error))
+            return nullptr;
+
+        return dispatch_size(rows, columns, [&]<std::size_t Row, std::size_t Column>() {
+            ParseError parse_error;
+            auto       parsed = parse<Row, Column>(roster, parse_error);
+
+            if (!parsed)
+            {
+                error = "line " + std::to_string(parse_error.line) + ": " + parse_error.message;
+                return std::shared_ptr<ServiceJob>{};
+            }
+
+            if (weights)
+                parsed->class_info.set_weights(*weights);
+
+            return dispatch_scoring(scoring, runtime_scoring, [&](const auto& policy) {
+                if (!parsed->chart.seat_feasibly(parsed->class_info, policy))
+                {
+                    error = "the seat rules cannot all be met";
+                    return std::shared_ptr<ServiceJob>{};
+                }
+
+                return make_service_job<Row, Column>(std::move(*parsed), limits, config, policy,
+                                                     std::move(on_improved));
+            });
+        });
+    };
+
+    return run_service(std::cin, std::cout, config.threads, max_jobs, factory);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    constexpr std::size_t Patience = 1500;
+
+    SearchConfig config{std::max(1u, std::thread::hardware_concurrency()),
+                        std::random_device{}(),
+                        Patience,
+                        SearchStrategy::HillClimb,
+                        {5.0, 0.05, 1000000, CoolingSchedule::Geometric},
+                        {5000, 40}};
+
+    bool                        genetic    = false;
+    std::size_t                 population = 1000;
+    std::string_view            input      = "6_by_8.txt";
+    double                      stats      = 0;
+    std::string                 save_as;
+    RuntimeScoring              scoring{2, DistanceKind::Euclidean};
+    bool                        runtime_scoring = false;
+    std::optional<ScoreWeights> weights;
+    bool                        exact         = false;
+    double                      exact_seconds = 0;
+    IslandSettings              island;
+    std::string_view            batch;
+    std::string                 batch_output  = ".";
+    std::string_view            edits         = "";
+    std::size_t                 reseat_radius = 1;
+    bool                        serve         = false;
+    std::size_t                 max_jobs      = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view flag = argv[i];
+
+        if (i + 1 < argc && flag == "--threads" && parse_number(argv[i + 1], config.threads)
+            && config.threads > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--seed" && parse_number(argv[i + 1], config.seed))
+            i++;
+        else if (i + 1 < argc && flag == "--lanes" && parse_number(argv[i + 1], config.lanes)
+                 && config.lanes > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--restarts" && parse_number(argv[i + 1], config.restarts)
+                 && config.restarts > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--seconds" && parse_number(argv[i + 1], config.seconds)
+                 && config.seconds > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--trace")
+            config.trace = argv[++i];
+        else if (i + 1 < argc && flag == "--population" && parse_number(argv[i + 1], population)
+                 && population > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--input")
+            input = argv[++i];
+        else if (flag == "--genetic")
+            genetic = true;
+        else if (flag == "--exact")
+            exact = true;
+        else if (i + 1 < argc && flag == "--exact-seconds"
+                 && parse_number(argv[i + 1], exact_seconds) && exact_seconds > 0)
+            i++;
+        else if (flag == "--lookahead")
+            config.strategy = SearchStrategy::Lookahead;
+        else if (flag == "--anneal")
+            config.strategy = SearchStrategy::Anneal;
+        else if (i + 1 < argc && flag == "--anneal-steps"
+                 && parse_number(argv[i + 1], config.annealing.steps) && config.annealing.steps > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--initial-temperature"
+                 && parse_number(argv[i + 1], config.annealing.initial_temperature))
+            i++;
+        else if (i + 1 < argc && flag == "--final-temperature"
+                 && parse_number(argv[i + 1], config.annealing.final_temperature)
+                 && config.annealing.final_temperature > 0)
+            i++;
+        else if (flag == "--linear-cooling")
+            config.annealing.cooling = CoolingSchedule::Linear;
+        else if (flag == "--tabu")
+            config.strategy = SearchStrategy::Tabu;
+        else if (i + 1 < argc && flag == "--tabu-iterations"
+                 && parse_number(argv[i + 1], config.tabu.iterations))
+            i++;
+        else if (i + 1 < argc && flag == "--tabu-tenure"
+                 && parse_number(argv[i + 1], config.tabu.tenure))
+            i++;
+        else if (i + 1 < argc && flag == "--stats" && parse_number(argv[i + 1], stats)
+                 && stats > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--checkpoint")
+            config.checkpoint = argv[++i];
+        else if (i + 1 < argc && flag == "--save-snapshot")
+            save_as = argv[++i];
+        else if (i + 1 < argc && flag == "--export"
+                 && parse_export_mode(argv[i + 1], config.exports.mode))
+            i++;
+        else if (i + 1 < argc && flag == "--export-top"
+                 && parse_number(argv[i + 1], config.exports.top) && config.exports.top > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--export-interval"
+                 && parse_number(argv[i + 1], config.exports.interval_seconds)
+                 && config.exports.interval_seconds > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--table-seats"
+                 && parse_number(argv[i + 1], scoring.seats_per_table)
+                 && scoring.seats_per_table > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--distance"
+                 && parse_distance_kind(argv[i + 1], scoring.kind))
+            i++;
+        else if (i + 1 < argc && flag == "--weights" && parse_weights(argv[i + 1], weights.emplace()))
+            i++;
+        else if (flag == "--runtime-scoring")
+            runtime_scoring = true;
+        else if (i + 1 < argc && flag == "--island")
+            island.listen = argv[++i];
+        else if (i + 1 < argc && flag == "--peer")
+            island.peers.emplace_back(argv[++i]);
+        else if (i + 1 < argc && flag == "--migration-interval"
+                 && parse_number(argv[i + 1], island.interval) && island.interval > 0)
+            i++;
+        else if (i + 1 < argc && flag == "--edit")
+            edits = argv[++i];
+        else if (i + 1 < argc && flag == "--reseat-radius"
+                 && parse_number(argv[i + 1], reseat_radius))
+            i++;
+        else if (i + 1 < argc && flag == "--batch")
+            batch = argv[++i];
+        else if (i + 1 < argc && flag == "--batch-output")
+            batch_output = argv[++i];
+        else if (flag == "--serve")
+            serve = true;
+        else if (i + 1 < argc && flag == "--max-jobs" && parse_number(argv[i + 1], max_jobs)
+                 && max_jobs > 0)
+            i++;
+        else
         {
-            std::cout << "Stuck? Resetting..." << std::endl;
-            seating_chart.random_shuffle(rng);
-            best_value                  = -1000;
-            iterations_since_last_raise = 0;
+            std::cerr << "Usage: " << argv[0]
+                      << " [--input FILE] [--threads N] [--seed S] [--lanes N] [--restarts N]"
+                         " [--seconds T] [--trace FILE]"
+                         " [--genetic [--population N]]"
+                         " [--exact [--exact-seconds T]]"
+                         " [--lookahead] [--anneal [--anneal-steps N] [--initial-temperature T]"
+                         " [--final-temperature T] [--linear-cooling]]"
+                         " [--tabu [--tabu-iterations N] [--tabu-tenure N]] [--stats SECONDS]"
+                         " [--checkpoint FILE] [--save-snapshot FILE]"
+                         " [--export every|best|top|rolling [--export-top K]"
+                         " [--export-interval SECONDS]] [--table-seats N]"
+                         " [--distance euclidean|manhattan|rows] [--weights TABLEMATE,FRIEND,ENEMY]"
+                         " [--runtime-scoring] [--island ADDRESS [--peer ADDRESS]..."
+                         " [--migration-interval N]] [--batch MANIFEST [--batch-output DIR]]"
+                         " [--edit FILE [--reseat-radius N]] [--serve [--max-jobs N]]"
+                      << std::endl;
+            return 1;
         }
     }
+
+    if (stats > 0 && !StatsEnabled)
+    {
+        std::cerr << "--stats needs a build configured with -DSEATINGCHART_STATS=ON" << std::endl;
+        return 1;
+    }
+
+    if (!island.peers.empty() && island.listen.empty())
+    {
+        std::cerr << "--peer needs --island" << std::endl;
+        return 1;
+    }
+
+    if (!batch.empty())
+        return run_batch_mode(batch, batch_output, config, scoring, runtime_scoring, weights);
+
+    // By default every thread works on a job of its own
+    if (serve)
+        return run_service_mode(config, max_jobs > 0 ? max_jobs : config.threads, scoring,
+                                runtime_scoring, weights);
+
+    // Addresses are "unix:PATH" or "HOST:PORT"
+    std::optional<MigrationChannel> channel;
+    std::string                     channel_error;
+
+    if (!island.listen.empty()
+        && !channel.emplace(island.listen, island.peers, channel_error).is_open())
+    {
+        std::cerr << "--island: " << channel_error << std::endl;
+        return 1;
+    }
+
+    const MappedFile edits_file{edits.data()};
+
+    if (!edits.empty() && !edits_file.is_open())
+    {
+        std::cerr << "Cannot open " << edits << std::endl;
+        return 1;
+    }
+
+    const MappedFile file{input.data()};
+    std::size_t      rows, columns;
+    SnapshotView     snapshot;
+    std::string      load_error;
+
+    if (!read_room_size(file, snapshot, rows, columns, load_error)
+        || !check_tables(scoring, columns, load_error))
+    {
+        std::cerr << input << ": " << load_error << std::endl;
+        return 1;
+    }
+
+    std::cout << "Room: " << rows << "x" << columns << std::endl;
+    std::cout << "Patience: " << Patience << std::endl;
+    std::cout << "Threads: " << config.threads << std::endl;
+    std::cout << "Seed: " << config.seed << std::endl;
+    std::cout << "Lanes: " << config.lanes << std::endl;
+
+    // Progress statistics go to stderr as JSON lines, apart from the "New High" log
+    std::optional<StatsReporter> reporter;
+
+    if (stats > 0)
+        reporter.emplace(std::cerr, std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                      std::chrono::duration<double>(stats)));
+
+    return dispatch_size(rows, columns, [&]<std::size_t Row, std::size_t Column>() {
+        auto parsed = load_class<Row, Column>(file, snapshot, load_error);
+
+        if (!parsed)
+        {
+            std::cerr << input << ":" << load_error << std::endl;
+            return 1;
+        }
+
+        if (!save_as.empty())
+        {
+            if (!save_snapshot(save_as, parsed->lookup_name, parsed->chart, parsed->class_info))
+            {
+                std::cerr << "Cannot write snapshot " << save_as << std::endl;
+                return 1;
+            }
+
+            return 0;
+        }
+
+        if (weights)
+            parsed->class_info.set_weights(*weights);
+
+        if (exact && parsed->chart.size() > MaxExactSeats)
+        {
+            std::cerr << "--exact takes rooms of at most " << MaxExactSeats << " seats" << std::endl;
+            return 1;
+        }
+
+        return dispatch_scoring(scoring, runtime_scoring, [&](const auto& policy) {
+            // Every search keeps the seat rules from its starting chart on
+            if (!parsed->chart.seat_feasibly(parsed->class_info, policy))
+            {
+                std::cerr << input << ": the seat rules cannot all be met" << std::endl;
+                return 1;
+            }
+
+            auto* migration_channel = channel ? &*channel : nullptr;
+
+            if (!edits.empty())
+                return run_reseat(*parsed, edits, edits_file.view(), reseat_radius, config, policy);
+
+            if (exact)
+                run_exact(*parsed, config, exact_seconds, policy);
+            else if (genetic)
+                run_genetic(*parsed, population, config, policy, migration_channel,
+                            island.interval);
+            else
+                run_search(*parsed, config, policy, migration_channel, island.interval);
+
+            return 0;
+        });
+    });
 }
@@ -0,0 +1,45 @@
+#include "mappedfile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SeatingChartGenetic {
+
+MappedFile::MappedFile(const char* path) {
+    const int descriptor = ::open(path, O_RDONLY);
+
+    if (descriptor < 0)
+        return;
+
+    struct stat status;
+
+    if (::fstat(descriptor, &status) == 0)
+    {
+        size_ = static_cast<std::size_t>(status.st_size);
+
+        // mmap rejects empty mappings, but an empty file is still a valid (empty) view
+        if (size_ == 0)
+            open_ = true;
+        else if (void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                 mapping != MAP_FAILED)
+        {
+            ::madvise(mapping, size_, MADV_SEQUENTIAL);
+
+            data_ = static_cast<const char*>(mapping);
+            open_ = true;
+        }
+        else
+            size_ = 0;
+    }
+
+    ::close(descriptor);
+}
+
+MappedFile::~MappedFile() {
+    if (data_)
+        ::munmap(const_cast<char*>(data_), size_);
+}
+
+}
@@ -0,0 +1,28 @@
+#ifndef MAPPEDFILE_HPP_INCLUDED
+#define MAPPEDFILE_HPP_INCLUDED
+
+#include <cstddef>
+#include <string_view>
+
+namespace SeatingChartGenetic {
+
+// Read-only view of a whole file through mmap, so parsing can tokenize it in place.
+class MappedFile {
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool        open_ = false;
+
+   public:
+    explicit MappedFile(const char*);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] bool             is_open() const noexcept { return open_; }
+    [[nodiscard]] std::string_view view() const noexcept { return {data_, size_}; }
+};
+
+}
+
+#endif
@@ -0,0 +1,165 @@
+#include "migration.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace SeatingChartGenetic {
+
+namespace {
+
+constexpr std::string_view UnixPrefix = "unix:";
+
+// Resolves "unix:PATH" or "HOST:PORT", the host being bound to any interface when empty
+bool resolve(std::string_view           text,
+             bool                       passive,
+             MigrationChannel::Address& address,
+             int&                       family,
+             std::string&               error) {
+    if (text.starts_with(UnixPrefix))
+    {
+        const auto path = text.substr(UnixPrefix.size());
+        sockaddr_un unix_address{};
+
+        if (path.empty() || path.size() >= sizeof unix_address.sun_path)
+        {
+            error = "bad socket path in " + std::string{text};
+            return false;
+        }
+
+        unix_address.sun_family = AF_UNIX;
+        std::memcpy(unix_address.sun_path, path.data(), path.size());
+
+        std::memcpy(address.bytes.data(), &unix_address, sizeof unix_address);
+        address.length = sizeof unix_address;
+        family         = AF_UNIX;
+        return true;
+    }
+
+    const auto colon = text.rfind(':');
+
+    if (colon == std::string_view::npos)
+    {
+        error = "expected unix:PATH or HOST:PORT, not " + std::string{text};
+        return false;
+    }
+
+    const std::string host{text.substr(0, colon)};
+    const std::string port{text.substr(colon + 1)};
+
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags    = passive ? AI_PASSIVE : 0;
+
+    addrinfo* results = nullptr;
+
+    if (const int status =
+          ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &results);
+        status != 0)
+    {
+        error = std::string{text} + ": " + ::gai_strerror(status);
+        return false;
+    }
+
+    std::memcpy(address.bytes.data(), results->ai_addr, results->ai_addrlen);
+    address.length = static_cast<std::uint32_t>(results->ai_addrlen);
+    family         = results->ai_family;
+
+    ::freeaddrinfo(results);
+    return true;
+}
+
+}
+
+MigrationChannel::MigrationChannel(std::string_view             listen,
+                                   std::span<const std::string> peer_addresses,
+                                   std::string&                 error) {
+    Address own;
+    int     family;
+
+    if (!resolve(listen, true, own, family, error))
+        return;
+
+    for (const auto& text : peer_addresses)
+    {
+        Address peer;
+        int     peer_family;
+
+        if (!resolve(text, false, peer, peer_family, error))
+            return;
+
+        if (peer_family != family)
+        {
+            error = text + " is not the same kind of address as " + std::string{listen};
+            return;
+        }
+
+        peers.push_back(peer);
+    }
+
+    const int socket = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (socket < 0)
+    {
+        error = std::string{"cannot open a socket: "} + std::strerror(errno);
+        return;
+    }
+
+    // A socket file left by an island that did not shut down cleanly would block the bind
+    if (family == AF_UNIX)
+    {
+        unix_path = std::string{listen.substr(UnixPrefix.size())};
+        ::unlink(unix_path.c_str());
+    }
+
+    if (::bind(socket, reinterpret_cast<const sockaddr*>(own.bytes.data()), own.length) != 0)
+    {
+        error = "cannot bind " + std::string{listen} + ": " + std::strerror(errno);
+        unix_path.clear();
+        ::close(socket);
+        return;
+    }
+
+    descriptor = socket;
+}
+
+MigrationChannel::~MigrationChannel() {
+    if (descriptor >= 0)
+        ::close(descriptor);
+
+    if (!unix_path.empty())
+        ::unlink(unix_path.c_str());
+}
+
+void MigrationChannel::send(std::span<const std::byte> datagram) noexcept {
+    for (const auto& peer : peers)
+        ::sendto(descriptor, datagram.data(), datagram.size(), MSG_DONTWAIT,
+                 reinterpret_cast<const sockaddr*>(peer.bytes.data()), peer.length);
+}
+
+std::size_t MigrationChannel::receive(std::span<std::byte> buffer) noexcept {
+    while (true)
+    {
+        const auto bytes = ::recv(descriptor, buffer.data(), buffer.size(), MSG_DONTWAIT);
+
+        if (bytes > 0)
+            return static_cast<std::size_t>(bytes);
+
+        // Empty datagrams carry nothing, so skip them rather than report the channel drained
+        if (bytes == 0)
+            continue;
+
+        if (errno != EINTR)
+            return 0;
+    }
+}
+
+}
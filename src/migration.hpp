@@ -0,0 +1,178 @@
+#ifndef MIGRATION_HPP_INCLUDED
+#define MIGRATION_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "classinfo.hpp"
+#include "seatingchart.hpp"
+#include "simulation.hpp"
+
+namespace SeatingChartGenetic {
+
+// Datagram socket linking one island of an island-model search to its peers. Islands are
+// separate processes, one per NUMA node or host, that share nothing but the charts sent here:
+// sending never waits, a datagram to a peer that is busy or not up yet is dropped, and
+// receiving returns at once when nothing is pending. Addresses are "unix:PATH" for islands
+// on one host, or "HOST:PORT" for UDP across hosts; an island and its peers use one kind.
+class MigrationChannel {
+   public:
+    struct Address {
+        std::array<std::byte, 128> bytes;
+        std::uint32_t              length;
+    };
+
+   private:
+    int                  descriptor = -1;
+    std::string          unix_path;
+    std::vector<Address> peers;
+
+   public:
+    // On failure the channel is left closed and `error` says why
+    MigrationChannel(std::string_view, std::span<const std::string>, std::string& error);
+    ~MigrationChannel();
+
+    MigrationChannel(const MigrationChannel&)            = delete;
+    MigrationChannel& operator=(const MigrationChannel&) = delete;
+
+    [[nodiscard]] bool is_open() const noexcept { return descriptor >= 0; }
+
+    // Sends to every peer
+    void send(std::span<const std::byte>) noexcept;
+
+    // Size of the next pending datagram, truncated to the buffer, or 0 when none is pending
+    [[nodiscard]] std::size_t receive(std::span<std::byte>) noexcept;
+};
+
+// Sends an island's best chart to its peers and picks the best chart they sent. A migrant is
+// the seats listed row-major after a magic number and the seat count; peers must search the
+// same class, so migrants are rescored here and ones that break the seat rules are dropped.
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+class Migration {
+    static constexpr std::uint32_t Magic       = 0x53434d47;
+    static constexpr std::size_t   HeaderBytes = 2 * sizeof(std::uint32_t);
+
+    MigrationChannel&              channel;
+    const ClassInfo<Row * Column>& class_info;
+    [[no_unique_address]] Policy   policy;
+
+    // Sized for one migrant of this room, with a spare byte so longer datagrams show as such
+    std::vector<std::byte> outgoing, incoming;
+
+    [[nodiscard]] bool decode(std::size_t, SeatingChart<Row, Column>&) const;
+
+   public:
+    Migration(MigrationChannel&, const ClassInfo<Row * Column>&, Policy = {});
+
+    void emigrate(const SeatingChart<Row, Column>&);
+
+    // Drains the channel and leaves the best valid migrant in `chart`, if there was one
+    [[nodiscard]] bool immigrate(SeatingChart<Row, Column>& chart, double& score);
+};
+
+}
+
+namespace SeatingChartGenetic {
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+Migration<Row, Column, Policy>::Migration(MigrationChannel&              migration_channel,
+                                          const ClassInfo<Row * Column>& cinfo,
+                                          Policy                         scoring) :
+    channel{migration_channel},
+    class_info{cinfo},
+    policy{scoring},
+    outgoing(HeaderBytes + cinfo.size() * sizeof(std::uint32_t)),
+    incoming(outgoing.size() + 1) {}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+void Migration<Row, Column, Policy>::emigrate(const SeatingChart<Row, Column>& chart) {
+    const std::uint32_t header[] = {Magic, static_cast<std::uint32_t>(chart.size())};
+    std::memcpy(outgoing.data(), header, HeaderBytes);
+
+    auto* seat = outgoing.data() + HeaderBytes;
+
+    for (const auto& row : chart.seats())
+    {
+        for (const auto student : row)
+        {
+            const auto value = static_cast<std::uint32_t>(student);
+            std::memcpy(seat, &value, sizeof value);
+            seat += sizeof value;
+        }
+    }
+
+    channel.send(outgoing);
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+bool Migration<Row, Column, Policy>::immigrate(SeatingChart<Row, Column>& chart, double& score) {
+    bool found = false;
+
+    for (auto bytes = channel.receive(incoming); bytes > 0; bytes = channel.receive(incoming))
+    {
+        SeatingChart<Row, Column> migrant{chart};
+
+        if (!decode(bytes, migrant) || !class_info.allows(migrant, policy))
+            continue;
+
+        const double migrant_score = score_chart(migrant, class_info, policy);
+
+        if (!found || migrant_score > score)
+        {
+            chart = migrant;
+            score = migrant_score;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+// Rebuilds `chart`, which has the room's size, from a datagram of `bytes` bytes, failing
+// unless it seats every student of the room exactly once
+template<std::size_t Row, std::size_t Column, typename Policy>
+bool Migration<Row, Column, Policy>::decode(std::size_t bytes, SeatingChart<Row, Column>& chart) const {
+    if (bytes != outgoing.size())
+        return false;
+
+    std::uint32_t header[2];
+    std::memcpy(header, incoming.data(), HeaderBytes);
+
+    if (header[0] != Magic || header[1] != chart.size())
+        return false;
+
+    auto seats = make_fixed_or_dynamic<Row>(
+      chart.rows(), make_fixed_or_dynamic<Column, std::size_t>(chart.columns()));
+    std::vector<bool> seated(chart.size(), false);
+
+    const auto* seat = incoming.data() + HeaderBytes;
+
+    for (auto& row : seats)
+    {
+        for (auto& student : row)
+        {
+            std::uint32_t value;
+            std::memcpy(&value, seat, sizeof value);
+            seat += sizeof value;
+
+            if (value >= chart.size() || seated[value])
+                return false;
+
+            seated[value] = true;
+            student       = value;
+        }
+    }
+
+    chart = SeatingChart<Row, Column>{std::move(seats)};
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,529 @@
+#ifndef PARALLELSEARCH_HPP_INCLUDED
+#define PARALLELSEARCH_HPP_INCLUDED
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "anytime.hpp"
+#include "classinfo.hpp"
+#include "exportpipeline.hpp"
+#include "random.hpp"
+#include "seatingchart.hpp"
+#include "simulation.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
+
+namespace SeatingChartGenetic {
+
+enum class SearchStrategy {
+    HillClimb,
+    Lookahead,
+    Anneal,
+    Tabu
+};
+
+struct SearchConfig {
+    std::size_t       threads;
+    std::uint64_t     seed;
+    std::size_t       patience;
+    SearchStrategy    strategy;
+    AnnealingSchedule annealing;
+    TabuSettings      tabu;
+
+    // Snapshot rewritten with every new best chart, so a killed search can resume from it
+    std::string checkpoint = {};
+
+    ExportSettings exports = {ExportMode::Every, 5, 10.0};
+
+    // Chains of restarts that share nothing, run by however many threads there are. With the
+    // same seed, lanes and restart budget, a search finds the same charts on any thread count.
+    std::size_t lanes = 64;
+
+    // Restarts over all lanes before the search ends, or 0 to run until stopped
+    std::size_t restarts = 0;
+
+    // Wall time before the search ends, or 0 for no limit. Restarts still running at the
+    // deadline are cut short, so the search returns within a millisecond or so of it.
+    double seconds = 0;
+
+    // TSV file the score of the best chart over time is written to when the search ends
+    std::string trace = {};
+};
+
+inline constexpr std::size_t DefaultShuffleSwaps = 12;
+
+template<std::size_t ShuffleSwaps,
+         std::size_t Row,
+         std::size_t Column,
+         typename Policy,
+         typename PRNG>
+double search_restart(SeatingChart<Row, Column>&,
+                      ChartScorer<Row, Column, Policy>&,
+                      const SearchConfig&,
+                      PRNG&,
+                      const StopToken& = {});
+
+// One chain of restarts with its own chart and PRNG, reshuffled once `patience` restarts in a
+// row fail to raise its best. Lane i of n draws from the seed's stream jumped i times, and its
+// k-th restart is restart k * n + i of the search.
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+class SearchLane {
+    Xoshiro256                       rng;
+    ChartScorer<Row, Column, Policy> scorer;
+    SeatingChart<Row, Column>        chart_;
+    std::size_t                      index, lanes;
+
+    double      local_best;
+    std::size_t iterations_since_last_raise = 0;
+    std::size_t restarts_                   = 0;
+
+    // Only a higher score replaces the best, so it is the lane's earliest chart of that score
+    double                    best_score_;
+    SeatingChart<Row, Column> best_chart_;
+    std::size_t               best_restart_ = 0;
+
+   public:
+    SearchLane(const SeatingChart<Row, Column>&,
+               const ClassInfo<Row * Column>&,
+               Policy,
+               std::uint64_t seed,
+               std::size_t   index,
+               std::size_t   lanes);
+
+    // Returns the score of the local optimum the chart is left at, or of where the climb had
+    // got to when `stop` asked
+    template<std::size_t ShuffleSwaps>
+    double restart(const SearchConfig&, const StopToken& = {});
+
+    // Continues the chain from a chart found elsewhere, such as a migrant
+    void restart_from(const SeatingChart<Row, Column>&);
+
+    [[nodiscard]] const SeatingChart<Row, Column>& chart() const noexcept { return chart_; }
+    [[nodiscard]] std::size_t restarts() const noexcept { return restarts_; }
+
+    // Number in the whole search of the restart that left the current chart
+    [[nodiscard]] std::size_t last_restart() const noexcept {
+        return (restarts_ - 1) * lanes + index;
+    }
+
+    [[nodiscard]] double                           best_score() const noexcept { return best_score_; }
+    [[nodiscard]] const SeatingChart<Row, Column>& best_chart() const noexcept { return best_chart_; }
+    [[nodiscard]] std::size_t best_restart() const noexcept { return best_restart_; }
+};
+
+// The lanes of one search and the restarts each has left. A thread takes a lane for a single
+// restart at a time, so any number of threads can share the lanes while every lane runs its
+// restarts in order. A budget of N restarts gives lane i the restarts numbered i, i + lanes,
+// ... below N.
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+class SearchLanes {
+    std::vector<SearchLane<Row, Column, Policy>> lanes;
+    std::vector<std::atomic<bool>>               taken;
+    std::size_t                                  budget;
+    std::atomic<std::size_t>                     cursor, exhausted;
+
+    [[nodiscard]] std::size_t quota(std::size_t lane) const noexcept {
+        return budget / lanes.size() + (lane < budget % lanes.size());
+    }
+
+   public:
+    SearchLanes(const SeatingChart<Row, Column>&,
+                const ClassInfo<Row * Column>&,
+                const SearchConfig&,
+                Policy = {});
+
+    // Calls `function(lane)` on a free lane with restarts left, or returns false once every
+    // lane has run its share of the budget
+    template<typename Function>
+    bool with_lane(Function&&);
+
+    // The best chart of every lane, ties going to the earliest restart. No thread may hold a
+    // lane meanwhile.
+    [[nodiscard]] const SearchLane<Row, Column, Policy>& best() const noexcept;
+};
+
+// Restart-based search on several threads. A restart either perturbs the chart with a partial
+// shuffle, optionally followed by tabu search, or anneals it; it then hill climbs to a local
+// optimum, optionally escaping single-swap optima with two-swap lookahead. Workers run the
+// restarts of SearchLanes; the only shared state on the hot path is the best score, and
+// improved charts are handed to an ExportPipeline so workers never touch the disk. A worker
+// checks the pipeline's threshold, one atomic load, before offering a chart. The log and the
+// exports follow the order charts were found in, but the best chart of a run with a restart
+// budget, reported when it ends, depends only on the seed, lanes and budget. Migrants and a
+// time budget make a run depend on timing.
+template<std::size_t Row,
+         std::size_t Column,
+         typename Policy          = DefaultScoring,
+         std::size_t ShuffleSwaps = DefaultShuffleSwaps>
+class ParallelSearch {
+    const SeatingChart<Row, Column>                  seed_chart;
+    const ClassInfo<Row * Column>&                   class_info;
+    const FixedOrDynamic<Row * Column, std::string>& names;
+    const SearchConfig                               config;
+    [[no_unique_address]] const Policy               policy;
+
+    SearchLanes<Row, Column, Policy> lanes;
+
+    std::atomic<double>      best_score_;
+    std::atomic<std::size_t> restarts_;
+    std::atomic<bool>        stopping;
+    StopToken                stop_token;
+    ScoreTrace               trace;
+
+    // The best chart for other islands, and the latest one they sent, which the first worker
+    // to see the flag restarts from
+    mutable std::mutex        migration_mutex;
+    SeatingChart<Row, Column> best_chart_;
+    SeatingChart<Row, Column> migrant;
+    std::atomic<bool>         migrant_ready;
+
+    ExportPipeline<Row, Column> pipeline;
+
+    void work();
+    void publish(double, std::size_t, const SeatingChart<Row, Column>&);
+    void report_best(double, const SeatingChart<Row, Column>&);
+
+   public:
+    ParallelSearch(const SeatingChart<Row, Column>&,
+                   const ClassInfo<Row * Column>&,
+                   const FixedOrDynamic<Row * Column, std::string>&,
+                   SearchConfig,
+                   Policy = {});
+
+    // Returns once the restart budget or the time is spent, or after stop(), which also cuts
+    // short the restarts in flight
+    void run();
+    void stop() noexcept;
+
+    [[nodiscard]] double      best_score() const noexcept { return best_score_.load(); }
+    [[nodiscard]] std::size_t restarts() const noexcept { return restarts_.load(); }
+
+    // Best chart exported so far, for migration
+    [[nodiscard]] SeatingChart<Row, Column> best_chart() const;
+
+    void immigrate(const SeatingChart<Row, Column>&);
+};
+
+}
+
+namespace SeatingChartGenetic {
+
+// One restart of the configured strategy, shared by the search workers and the benchmarks.
+// Returns the score of the local optimum the chart is left at.
+template<std::size_t ShuffleSwaps,
+         std::size_t Row,
+         std::size_t Column,
+         typename Policy,
+         typename PRNG>
+double search_restart(SeatingChart<Row, Column>&        chart,
+                      ChartScorer<Row, Column, Policy>& scorer,
+                      const SearchConfig&               config,
+                      PRNG&                             rng,
+                      const StopToken&                  stop) {
+    count(StatCounter::Restarts);
+
+    if (config.strategy == SearchStrategy::Anneal)
+    {
+        PhaseTimer timer{StatPhase::Anneal};
+        chart.anneal(scorer, config.annealing, rng, stop);
+    }
+    else
+    {
+        PhaseTimer timer{StatPhase::Perturb};
+        chart.template partial_random_shuffle<PRNG, ShuffleSwaps>(rng, scorer);
+    }
+
+    if (config.strategy == SearchStrategy::Tabu)
+    {
+        PhaseTimer timer{StatPhase::Tabu};
+        chart.tabu_search(scorer, config.tabu, stop);
+    }
+
+    PhaseTimer timer{StatPhase::Climb};
+
+    if (config.strategy == SearchStrategy::Lookahead)
+        while (chart.hill_climb_combined(scorer, stop) || chart.hill_climb_lookahead(scorer, stop))
+            count(StatCounter::ClimbSteps);
+    else
+        while (chart.hill_climb_combined(scorer, stop))
+            count(StatCounter::ClimbSteps);
+
+    return scorer(chart);
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+SearchLane<Row, Column, Policy>::SearchLane(const SeatingChart<Row, Column>& chart,
+                                            const ClassInfo<Row * Column>&   cinfo,
+                                            Policy                           policy,
+                                            std::uint64_t                    seed,
+                                            std::size_t                      lane,
+                                            std::size_t                      lane_count) :
+    rng{seed},
+    scorer{cinfo, policy},
+    chart_{chart},
+    index{lane},
+    lanes{lane_count},
+    // Starting from the seed's score lets a search resumed from a checkpoint keep its best
+    local_best{scorer(chart)},
+    best_score_{local_best},
+    best_chart_{chart} {
+    for (std::size_t i = 0; i < index; i++)
+        rng.jump();
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+template<std::size_t ShuffleSwaps>
+double SearchLane<Row, Column, Policy>::restart(const SearchConfig& config,
+                                                const StopToken&    stop) {
+    const double score = search_restart<ShuffleSwaps>(chart_, scorer, config, rng, stop);
+
+    restarts_++;
+    iterations_since_last_raise++;
+
+    if (score > best_score_)
+    {
+        best_score_   = score;
+        best_chart_   = chart_;
+        best_restart_ = last_restart();
+    }
+
+    if (score > local_best)
+    {
+        local_best                  = score;
+        iterations_since_last_raise = 0;
+    }
+
+    if (iterations_since_last_raise > config.patience)
+    {
+        chart_.random_shuffle(rng, scorer);
+        local_best                  = -1000;
+        iterations_since_last_raise = 0;
+    }
+
+    return score;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+void SearchLane<Row, Column, Policy>::restart_from(const SeatingChart<Row, Column>& chart) {
+    chart_                      = chart;
+    local_best                  = scorer(chart_);
+    iterations_since_last_raise = 0;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+SearchLanes<Row, Column, Policy>::SearchLanes(const SeatingChart<Row, Column>& chart,
+                                              const ClassInfo<Row * Column>&   cinfo,
+                                              const SearchConfig&              config,
+                                              Policy                           policy) :
+    taken(config.lanes),
+    budget{config.restarts},
+    cursor{0},
+    exhausted{0} {
+    assert(config.lanes > 0);
+
+    lanes.reserve(config.lanes);
+
+    for (std::size_t i = 0; i < config.lanes; i++)
+    {
+        lanes.emplace_back(chart, cinfo, policy, config.seed, i, config.lanes);
+
+        if (budget > 0 && quota(i) == 0)
+            exhausted.fetch_add(1);
+    }
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+template<typename Function>
+bool SearchLanes<Row, Column, Policy>::with_lane(Function&& function) {
+    for (std::size_t tries = 1; exhausted.load(std::memory_order_relaxed) < lanes.size(); tries++)
+    {
+        const auto i = cursor.fetch_add(1, std::memory_order_relaxed) % lanes.size();
+
+        // More threads than lanes with restarts left
+        if (tries % lanes.size() == 0)
+            std::this_thread::yield();
+
+        if (taken[i].exchange(true, std::memory_order_acquire))
+            continue;
+
+        auto& lane = lanes[i];
+
+        if (budget > 0 && lane.restarts() >= quota(i))
+        {
+            taken[i].store(false, std::memory_order_release);
+            continue;
+        }
+
+        function(lane);
+
+        if (budget > 0 && lane.restarts() == quota(i))
+            exhausted.fetch_add(1);
+
+        taken[i].store(false, std::memory_order_release);
+        return true;
+    }
+
+    return false;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+const SearchLane<Row, Column, Policy>& SearchLanes<Row, Column, Policy>::best() const noexcept {
+    const auto* best = &lanes.front();
+
+    for (const auto& lane : lanes)
+        if (lane.best_score() > best->best_score()
+            || (lane.best_score() == best->best_score() && lane.best_restart() < best->best_restart()))
+            best = &lane;
+
+    return *best;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy, std::size_t ShuffleSwaps>
+ParallelSearch<Row, Column, Policy, ShuffleSwaps>::ParallelSearch(
+  const SeatingChart<Row, Column>&                 chart,
+  const ClassInfo<Row * Column>&                   cinfo,
+  const FixedOrDynamic<Row * Column, std::string>& lookup_name,
+  SearchConfig                                     search_config,
+  Policy                                           scoring) :
+    seed_chart{chart},
+    class_info{cinfo},
+    names{lookup_name},
+    config{search_config},
+    policy{scoring},
+    lanes{chart, cinfo, config, policy},
+    best_score_{score_chart(chart, cinfo, policy)},
+    restarts_{0},
+    stopping{false},
+    best_chart_{chart},
+    migrant{chart},
+    migrant_ready{false},
+    pipeline{chart,
+             best_score_.load(),
+             lookup_name,
+             config.exports,
+             2 * config.threads,
+             [this](double score, std::size_t, const SeatingChart<Row, Column>& best) {
+                 report_best(score, best);
+             }} {}
+
+template<std::size_t Row, std::size_t Column, typename Policy, std::size_t ShuffleSwaps>
+void ParallelSearch<Row, Column, Policy, ShuffleSwaps>::run() {
+    trace.restart_clock();
+    stop_token = StopToken{stopping, deadline_after(config.seconds)};
+
+    std::vector<std::thread> workers;
+    workers.reserve(config.threads);
+
+    for (std::size_t i = 0; i < config.threads; i++)
+        workers.emplace_back(&ParallelSearch::work, this);
+
+    for (auto& worker : workers)
+        worker.join();
+
+    stop();
+    pipeline.finish();
+
+    if (!config.trace.empty() && !write_file(config.trace.c_str(), trace.tsv()))
+        std::cerr << "Cannot write trace " << config.trace << std::endl;
+
+    if (config.restarts == 0 && config.seconds == 0)
+        return;
+
+    const auto& best = lanes.best();
+
+    std::cout << "Best: " << best.best_score() << " at restart " << best.best_restart()
+              << std::endl;
+
+    // The checkpoint may hold another chart of the same score, found first by the clock
+    if (!config.checkpoint.empty()
+        && !save_snapshot(config.checkpoint, names, best.best_chart(), class_info))
+        std::cerr << "Cannot write checkpoint " << config.checkpoint << std::endl;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy, std::size_t ShuffleSwaps>
+void ParallelSearch<Row, Column, Policy, ShuffleSwaps>::stop() noexcept {
+    stopping.store(true);
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy, std::size_t ShuffleSwaps>
+void ParallelSearch<Row, Column, Policy, ShuffleSwaps>::work() {
+    const auto restart = [&](SearchLane<Row, Column, Policy>& lane) {
+        if (migrant_ready.load(std::memory_order_relaxed) && migrant_ready.exchange(false))
+        {
+            std::lock_guard lock{migration_mutex};
+            lane.restart_from(migrant);
+        }
+
+        restarts_.fetch_add(1, std::memory_order_relaxed);
+
+        const double score = lane.template restart<ShuffleSwaps>(config, stop_token);
+
+        if (pipeline.admits(score))
+            publish(score, lane.last_restart(), lane.chart());
+    };
+
+    while (!stop_token.stop_requested() && lanes.with_lane(restart))
+    {}
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy, std::size_t ShuffleSwaps>
+void ParallelSearch<Row, Column, Policy, ShuffleSwaps>::publish(
+  double score, std::size_t restart, const SeatingChart<Row, Column>& chart) {
+    double global_best = best_score_.load(std::memory_order_relaxed);
+
+    while (score > global_best)
+    {
+        if (best_score_.compare_exchange_weak(global_best, score, std::memory_order_relaxed))
+        {
+            trace.record(score, restart);
+            break;
+        }
+    }
+
+    // Another thread may have exported a better chart since this one was admitted
+    if (pipeline.admits(score))
+        pipeline.submit(score, restart, chart);
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy, std::size_t ShuffleSwaps>
+SeatingChart<Row, Column> ParallelSearch<Row, Column, Policy, ShuffleSwaps>::best_chart() const {
+    std::lock_guard lock{migration_mutex};
+    return best_chart_;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy, std::size_t ShuffleSwaps>
+void ParallelSearch<Row, Column, Policy, ShuffleSwaps>::immigrate(
+  const SeatingChart<Row, Column>& chart) {
+    {
+        std::lock_guard lock{migration_mutex};
+        migrant = chart;
+    }
+
+    migrant_ready.store(true);
+}
+
+// Runs on the export thread, so the log and the checkpoint never hold up a worker
+template<std::size_t Row, std::size_t Column, typename Policy, std::size_t ShuffleSwaps>
+void ParallelSearch<Row, Column, Policy, ShuffleSwaps>::report_best(
+  double score, const SeatingChart<Row, Column>& chart) {
+    {
+        std::lock_guard lock{migration_mutex};
+        best_chart_ = chart;
+    }
+
+    if (!config.checkpoint.empty() && !save_snapshot(config.checkpoint, names, chart, class_info))
+        std::cerr << "Cannot write checkpoint " << config.checkpoint << std::endl;
+
+    std::cout << "New High: " << score << std::endl;
+}
+
+}
+
+#endif
@@ -1,110 +1,295 @@
 #ifndef PARSE_HPP_INCLUDED
 #define PARSE_HPP_INCLUDED
 
-#include <cassert>
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstddef>
-#include <fstream>
-#include <iomanip>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "classinfo.hpp"
 #include "seatingchart.hpp"
-#include "utils.hpp"
 
 namespace SeatingChartGenetic {
 
 template<std::size_t Row, std::size_t Column>
 struct ParseResult {
-    std::array<std::string, Row * Column> lookup_name;
-    SeatingChart<Row, Column>             chart;
-    ClassInfo<Row * Column>               class_info;
+    FixedOrDynamic<Row * Column, std::string> lookup_name;
+    SeatingChart<Row, Column>                 chart;
+    ClassInfo<Row * Column>                   class_info;
 };
 
+struct ParseError {
+    std::size_t line;
+    std::string message;
+};
+
+// Reads the "rows columns" header, leaving `text` just past it.
+[[nodiscard]] inline bool parse_room_size(std::string_view&, std::size_t&, std::size_t&);
+
+// Parses a whole input file held in memory, normally a MappedFile. Row and Column may be
+// Dynamic, in which case the chart takes the size given in the file. On malformed input,
+// including names that are not in the roster, returns nothing and fills the error.
+//
+// The enemies section may be followed by seat rules, one per line, with rows and columns
+// counted from 1 in the order the chart prints them:
+//   pin NAME ROW COLUMN      NAME always sits in that seat
+//   rows NAME FIRST LAST     NAME sits somewhere in rows FIRST to LAST
+//   apart NAME NAME          the two never share a table
 template<std::size_t Row, std::size_t Column>
-ParseResult<Row, Column> parse(std::ifstream&& input) {
-    int row, column;
-    input >> row >> column;
-    assert(row == Row && column == Column);
+[[nodiscard]] std::optional<ParseResult<Row, Column>> parse(std::string_view, ParseError&);
+
+}
+
+namespace SeatingChartGenetic {
+
+namespace {
+
+[[nodiscard]] constexpr bool is_space(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+[[nodiscard]] constexpr std::string_view trim(std::string_view text) noexcept {
+    while (!text.empty() && is_space(text.front()))
+        text.remove_prefix(1);
 
-    std::array<std::string, Row * Column>            lookup;
-    std::array<std::array<std::size_t, Column>, Row> seats;
+    while (!text.empty() && is_space(text.back()))
+        text.remove_suffix(1);
 
-    for (std::size_t i = 0; i < Row; i++)
+    return text;
+}
+
+// Splits off the next whitespace-separated token; empty once the text runs out.
+[[nodiscard]] constexpr std::string_view next_token(std::string_view& text) noexcept {
+    while (!text.empty() && is_space(text.front()))
+        text.remove_prefix(1);
+
+    std::size_t length = 0;
+
+    while (length < text.size() && !is_space(text[length]))
+        length++;
+
+    const auto token = text.substr(0, length);
+    text.remove_prefix(length);
+    return token;
+}
+
+// Splits off the text up to the next `delimiter`, consuming the delimiter.
+[[nodiscard]] constexpr std::string_view next_field(std::string_view& text,
+                                                   char              delimiter) noexcept {
+    const auto end   = text.find(delimiter);
+    const auto field = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    return field;
+}
+
+// Only computed when reporting an error, so the hot path never counts lines
+[[nodiscard]] constexpr std::size_t line_of(std::string_view input, const char* position) {
+    return 1 + std::count(input.data(), position, '\n');
+}
+
+}
+
+inline bool parse_room_size(std::string_view& text, std::size_t& rows, std::size_t& columns) {
+    for (auto* value : {&rows, &columns})
     {
-        for (std::size_t j = 0; j < Column; j++)
-        {
-            input >> lookup[i * Column + j];
-            seats[i][j] = i * Column + j;
-        }
+        const auto token = next_token(text);
+        const auto [end, error] =
+          std::from_chars(token.data(), token.data() + token.size(), *value);
+
+        if (error != std::errc{} || end != token.data() + token.size() || *value == 0)
+            return false;
     }
 
-    std::string                                line;
-    std::array<std::vector<int>, Row * Column> friends;
-    std::array<std::vector<int>, Row * Column> enemies;
+    return true;
+}
+
+template<std::size_t Row, std::size_t Column>
+std::optional<ParseResult<Row, Column>> parse(std::string_view input, ParseError& error) {
+    std::string_view text = input;
+
+    const auto fail = [&](const char* position, std::string message) {
+        error = {line_of(input, position), std::move(message)};
+        return std::nullopt;
+    };
 
-    for (std::uint64_t i = 0; i < Row * Column; i++)
+    std::size_t row, column;
+
+    if (!parse_room_size(text, row, column))
+        return fail(text.data(), "expected the room size as 'rows columns'");
+
+    if (Row != Dynamic && (row != Row || column != Column))
+        return fail(text.data(), "room size does not match this build");
+
+    if (row > MaxStudents / column)
+        return fail(text.data(), "more than " + std::to_string(MaxStudents) + " students");
+
+    const std::size_t students = row * column;
+
+    auto lookup = make_fixed_or_dynamic<Row * Column, std::string>(students);
+
+    auto seats =
+      make_fixed_or_dynamic<Row>(row, make_fixed_or_dynamic<Column, std::size_t>(column));
+
+    // Keys view the input itself, which outlives the parse
+    std::unordered_map<std::string_view, std::size_t> index_of;
+    index_of.reserve(students);
+
+    for (std::size_t i = 0; i < students; i++)
     {
-        std::getline(input, line);
+        const auto name = next_token(text);
 
-        if (line.empty())
-        {
-            i--;
-            continue;
-        }
+        if (name.empty())
+            return fail(text.data(), "expected " + std::to_string(students) + " names");
+
+        if (!index_of.try_emplace(name, i).second)
+            return fail(name.data(), "duplicate name '" + std::string(name) + "'");
+
+        lookup[i]                     = name;
+        seats[i / column][i % column] = i;
+    }
 
-        const auto  colon_idx = line.find(':');
-        const auto  key       = line.substr(0, colon_idx);
-        std::size_t index_key;
+    auto friends = make_fixed_or_dynamic<Row * Column, std::vector<int>>(students);
+    auto enemies = make_fixed_or_dynamic<Row * Column, std::vector<int>>(students);
 
-        for (std::size_t j = 0; j < size(lookup); j++)
+    // A friends section then an enemies section, each with one "name: other,other" line per
+    // student in any order; blank lines are skipped
+    for (auto* relations : {&friends, &enemies})
+    {
+        std::vector<bool> listed(students);
+
+        for (std::size_t entries = 0; entries < students;)
         {
-            if (key == lookup[j])
+            if (text.empty())
+                return fail(text.data(), "expected a line for every student in both the friends"
+                                         " and enemies sections");
+
+            auto line = trim(next_field(text, '\n'));
+
+            if (line.empty())
+                continue;
+
+            if (line.find(':') == std::string_view::npos)
+                return fail(line.data(), "expected 'name: other,other'");
+
+            const auto key     = trim(next_field(line, ':'));
+            const auto student = index_of.find(key);
+
+            if (student == index_of.end())
+                return fail(key.data(), "unknown student '" + std::string(key) + "'");
+
+            if (listed[student->second])
+                return fail(key.data(), "'" + std::string(key) + "' is listed twice");
+
+            listed[student->second] = true;
+            entries++;
+
+            while (!line.empty())
             {
-                index_key = j;
-                break;
+                const auto name = trim(next_field(line, ','));
+
+                if (name.empty())
+                    continue;
+
+                const auto other = index_of.find(name);
+
+                if (other == index_of.end())
+                    return fail(name.data(), "unknown student '" + std::string(name) + "'");
+
+                (*relations)[student->second].push_back(static_cast<int>(other->second));
             }
         }
+    }
 
-        const auto str_data = utils::split(line.substr(colon_idx + 2), ',');
+    std::vector<std::vector<std::uint16_t>> allowed(students);
+    SeatConstraints                         constraints;
 
-        for (const auto& person : str_data)
-            friends[index_key].push_back(
-              std::distance(lookup.begin(), std::find(lookup.begin(), lookup.end(), person)));
-    }
+    const auto parse_index = [&](std::string_view token, std::size_t limit, std::size_t& value) {
+        const auto [end, failure] = std::from_chars(token.data(), token.data() + token.size(), value);
+        return failure == std::errc{} && end == token.data() + token.size() && value >= 1
+               && value <= limit;
+    };
 
-    for (std::uint64_t i = 0; i < Row * Column; i++)
+    while (!text.empty())
     {
-        std::getline(input, line);
+        auto line = trim(next_field(text, '\n'));
 
         if (line.empty())
-        {
-            i--;
             continue;
+
+        const auto directive = next_token(line);
+
+        if (directive != "pin" && directive != "rows" && directive != "apart")
+            return fail(directive.data(), "unknown rule '" + std::string(directive)
+                                            + "', expected pin, rows or apart");
+
+        std::array<std::size_t, 2> students_named{};
+        const std::size_t          named_count = directive == "apart" ? 2 : 1;
+
+        for (std::size_t i = 0; i < named_count; i++)
+        {
+            const auto name    = next_token(line);
+            const auto student = index_of.find(name);
+
+            if (student == index_of.end())
+                return fail(name.empty() ? directive.data() : name.data(),
+                            "unknown student '" + std::string(name) + "'");
+
+            students_named[i] = student->second;
         }
 
-        const auto  colon_idx = line.find(':');
-        const auto  key       = line.substr(0, colon_idx);
-        std::size_t index_key;
+        if (directive == "apart")
+        {
+            if (students_named[0] == students_named[1])
+                return fail(directive.data(), "a student cannot be kept apart from themselves");
 
-        for (std::size_t j = 0; j < size(lookup); j++)
+            constraints.apart.emplace_back(students_named[0], students_named[1]);
+        }
+        else
         {
-            if (key == lookup[j])
+            const auto student = students_named[0];
+
+            if (!allowed[student].empty())
+                return fail(directive.data(), "'" + std::string(lookup[student])
+                                                + "' already has a seat rule");
+
+            const auto  first = next_token(line);
+            const auto  last  = next_token(line);
+            std::size_t from, to;
+
+            if (directive == "pin")
+            {
+                if (!parse_index(first, row, from) || !parse_index(last, column, to))
+                    return fail(directive.data(), "expected 'pin name row column' inside the room");
+
+                allowed[student].push_back(
+                  static_cast<std::uint16_t>((from - 1) * column + (to - 1)));
+            }
+            else
             {
-                index_key = j;
-                break;
+                if (!parse_index(first, row, from) || !parse_index(last, row, to) || from > to)
+                    return fail(directive.data(), "expected 'rows name first last' inside the room");
+
+                for (auto seat = (from - 1) * column; seat < to * column; seat++)
+                    allowed[student].push_back(static_cast<std::uint16_t>(seat));
             }
         }
 
-        const auto str_data = utils::split(line.substr(colon_idx + 2), ',');
-
-        for (const auto& person : str_data)
-            enemies[index_key].push_back(
-              std::distance(lookup.begin(), std::find(lookup.begin(), lookup.end(), person)));
+        if (!trim(line).empty())
+            return fail(line.data(), "unexpected '" + std::string(trim(line)) + "'");
     }
 
+    if (std::any_of(allowed.begin(), allowed.end(), [](const auto& seats) { return !seats.empty(); }))
+        constraints.allowed_seats = make_adjacency(allowed);
+
     return ParseResult<Row, Column>{
-      lookup, SeatingChart<Row, Column>{std::move(seats)},
-      ClassInfo<Row * Column>{std::move(friends), std::move(enemies)}};
+      std::move(lookup), SeatingChart<Row, Column>{std::move(seats)},
+      ClassInfo<Row * Column>{std::move(friends), std::move(enemies), std::move(constraints)}};
 }
 
 }
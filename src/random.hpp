@@ -0,0 +1,86 @@
+#ifndef RANDOM_HPP_INCLUDED
+#define RANDOM_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace SeatingChartGenetic {
+
+// xoshiro256++, a UniformRandomBitGenerator for the shuffles, mutations and annealing. It is a
+// few cycles a number, where std::default_random_engine takes a division, and a seed opens
+// any number of independent streams, so results need not depend on which thread drew what:
+//   - Xoshiro256{seed, stream} hashes both into the state, for streams keyed by a counter,
+//     such as one per child per generation;
+//   - jump() moves 2^128 numbers ahead, so the first few jumps of one seed never overlap.
+class Xoshiro256 {
+    std::array<std::uint64_t, 4> state;
+
+    [[nodiscard]] static constexpr std::uint64_t rotate(std::uint64_t x, int k) noexcept {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // SplitMix64, which the xoshiro authors recommend for filling the state
+    [[nodiscard]] static constexpr std::uint64_t split_mix(std::uint64_t& x) noexcept {
+        std::uint64_t z = (x += 0x9e3779b97f4a7c15);
+        z               = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z               = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+   public:
+    using result_type = std::uint64_t;
+
+    explicit constexpr Xoshiro256(std::uint64_t seed, std::uint64_t stream = 0) noexcept {
+        std::uint64_t key = stream;
+        std::uint64_t x   = seed ^ split_mix(key);
+
+        for (auto& word : state)
+            word = split_mix(x);
+    }
+
+    [[nodiscard]] static constexpr result_type min() noexcept { return 0; }
+    [[nodiscard]] static constexpr result_type max() noexcept {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    constexpr result_type operator()() noexcept {
+        const auto result = rotate(state[0] + state[3], 23) + state[0];
+        const auto t      = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotate(state[3], 45);
+
+        return result;
+    }
+
+    constexpr void jump() noexcept {
+        constexpr std::uint64_t Jump[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                                          0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+
+        std::array<std::uint64_t, 4> jumped{};
+
+        for (const auto word : Jump)
+        {
+            for (int bit = 0; bit < 64; bit++)
+            {
+                if (word & (std::uint64_t{1} << bit))
+                    for (std::size_t i = 0; i < jumped.size(); i++)
+                        jumped[i] ^= state[i];
+
+                (*this)();
+            }
+        }
+
+        state = jumped;
+    }
+};
+
+}
+
+#endif
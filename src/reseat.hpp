@@ -0,0 +1,383 @@
+#ifndef RESEAT_HPP_INCLUDED
+#define RESEAT_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "classinfo.hpp"
+#include "parse.hpp"
+#include "seatingchart.hpp"
+#include "simulation.hpp"
+
+namespace SeatingChartGenetic {
+
+// Relationships and seat rules of a class as plain lists, so small edits can be made without
+// rerunning a search: edit, build() the new ClassInfo, move the score by edit_score_delta(),
+// then reseat() the chart. Rooms are always full, so a student leaving makes their seat
+// vacant, a seat whose student has no relationships and no seat rules, and a student joining
+// takes over a vacant seat.
+template<std::size_t NumStudents>
+class ClassEditor {
+    std::vector<std::vector<int>>                        friends, enemies;
+    std::vector<std::vector<std::uint16_t>>              allowed;
+    std::vector<std::pair<std::uint16_t, std::uint16_t>> apart;
+    ScoreWeights                                         weights;
+
+    // Pairs whose relationship may have changed, and every student of them
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+
+    void touch(std::size_t, std::size_t);
+
+   public:
+    explicit ClassEditor(const ClassInfo<NumStudents>&);
+
+    [[nodiscard]] std::size_t size() const noexcept { return friends.size(); }
+
+    // Edges are directed, as in the roster: `student` lists `other`
+    void add_friend(std::size_t student, std::size_t other);
+    void remove_friend(std::size_t student, std::size_t other);
+    void add_enemy(std::size_t student, std::size_t other);
+    void remove_enemy(std::size_t student, std::size_t other);
+
+    // Drops every relationship to or from the student and their seat rules
+    void vacate(std::size_t);
+
+    [[nodiscard]] bool is_vacant(std::size_t) const noexcept;
+
+    [[nodiscard]] ClassInfo<NumStudents> build() const;
+
+    // The pairs edited so far, each once with the lower student first
+    [[nodiscard]] std::vector<std::pair<std::size_t, std::size_t>> edited_pairs() const;
+};
+
+// Applies an edit list to `editor`, renaming students in `names` as they join and leave.
+// One edit per line; blank lines and lines starting with '#' are skipped:
+//   friend NAME OTHER     NAME lists OTHER as a friend
+//   unfriend NAME OTHER   NAME no longer does
+//   enemy NAME OTHER      NAME lists OTHER as an enemy
+//   unenemy NAME OTHER    NAME no longer does
+//   leave NAME            NAME's seat becomes vacant, shown as "(NAME)"
+//   join NAME SEAT        NAME takes the vacant seat of SEAT, which is usually "(SOMEONE)"
+template<std::size_t NumStudents, typename Names>
+[[nodiscard]] bool parse_edits(std::string_view, Names&, ClassEditor<NumStudents>&, ParseError&);
+
+// Change in a chart's score when its class goes from `before` to `after`, which differ in the
+// relationships of `pairs` only; the cost is one pair term per pair instead of a rescoring.
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+[[nodiscard]] double edit_score_delta(const SeatingChart<Row, Column>&,
+                                      const ClassInfo<Row * Column>&                   before,
+                                      const ClassInfo<Row * Column>&                   after,
+                                      std::span<const std::pair<std::size_t, std::size_t>> pairs,
+                                      const Policy& = {});
+
+struct ReseatResult {
+    double      score;
+    std::size_t moves;
+
+    // Students whose moves were searched
+    std::size_t reach;
+};
+
+// Warm-starts from a chart that was good before an edit: hill climbs with the swaps that move
+// a student within `radius` relationship hops of an edited pair, in the edited class, until
+// none of them raises the score. `score` is the chart's score in the edited class.
+template<std::size_t Row, std::size_t Column, typename Policy>
+ReseatResult reseat(SeatingChart<Row, Column>&,
+                    ChartScorer<Row, Column, Policy>&,
+                    const ClassInfo<Row * Column>&,
+                    std::span<const std::pair<std::size_t, std::size_t>> pairs,
+                    double                                               score,
+                    std::size_t                                          radius = 1);
+
+}
+
+namespace SeatingChartGenetic {
+
+template<std::size_t NumStudents>
+ClassEditor<NumStudents>::ClassEditor(const ClassInfo<NumStudents>& class_info) :
+    friends(class_info.size()),
+    enemies(class_info.size()),
+    allowed(class_info.size()),
+    apart{class_info.constraints().apart},
+    weights{class_info.weights()} {
+    for (std::size_t student = 0; student < size(); student++)
+    {
+        friends[student].assign(class_info.friends_of(student).begin(),
+                                class_info.friends_of(student).end());
+        enemies[student].assign(class_info.enemies_of(student).begin(),
+                                class_info.enemies_of(student).end());
+        allowed[student].assign(class_info.allowed_seats_of(student).begin(),
+                                class_info.allowed_seats_of(student).end());
+    }
+}
+
+template<std::size_t NumStudents>
+void ClassEditor<NumStudents>::touch(std::size_t first, std::size_t second) {
+    pairs.emplace_back(std::min(first, second), std::max(first, second));
+}
+
+template<std::size_t NumStudents>
+void ClassEditor<NumStudents>::add_friend(std::size_t student, std::size_t other) {
+    if (std::find(friends[student].begin(), friends[student].end(), other) == friends[student].end())
+        friends[student].push_back(static_cast<int>(other));
+
+    touch(student, other);
+}
+
+template<std::size_t NumStudents>
+void ClassEditor<NumStudents>::remove_friend(std::size_t student, std::size_t other) {
+    std::erase(friends[student], static_cast<int>(other));
+    touch(student, other);
+}
+
+template<std::size_t NumStudents>
+void ClassEditor<NumStudents>::add_enemy(std::size_t student, std::size_t other) {
+    if (std::find(enemies[student].begin(), enemies[student].end(), other) == enemies[student].end())
+        enemies[student].push_back(static_cast<int>(other));
+
+    touch(student, other);
+}
+
+template<std::size_t NumStudents>
+void ClassEditor<NumStudents>::remove_enemy(std::size_t student, std::size_t other) {
+    std::erase(enemies[student], static_cast<int>(other));
+    touch(student, other);
+}
+
+template<std::size_t NumStudents>
+void ClassEditor<NumStudents>::vacate(std::size_t student) {
+    for (auto* relations : {&friends, &enemies})
+    {
+        for (const auto other : (*relations)[student])
+            touch(student, other);
+
+        (*relations)[student].clear();
+
+        for (std::size_t other = 0; other < size(); other++)
+            if (std::erase((*relations)[other], static_cast<int>(student)) > 0)
+                touch(student, other);
+    }
+
+    allowed[student].clear();
+    std::erase_if(apart, [&](const auto& pair) {
+        return pair.first == student || pair.second == student;
+    });
+}
+
+template<std::size_t NumStudents>
+bool ClassEditor<NumStudents>::is_vacant(std::size_t student) const noexcept {
+    const auto lists = [&](const auto& relations) {
+        return std::any_of(relations.begin(), relations.end(), [&](const auto& list) {
+            return std::find(list.begin(), list.end(), static_cast<int>(student)) != list.end();
+        });
+    };
+
+    return friends[student].empty() && enemies[student].empty() && allowed[student].empty()
+        && !lists(friends) && !lists(enemies)
+        && std::none_of(apart.begin(), apart.end(), [&](const auto& pair) {
+               return pair.first == student || pair.second == student;
+           });
+}
+
+template<std::size_t NumStudents>
+ClassInfo<NumStudents> ClassEditor<NumStudents>::build() const {
+    SeatConstraints constraints{{}, apart};
+
+    if (std::any_of(allowed.begin(), allowed.end(), [](const auto& seats) { return !seats.empty(); }))
+        constraints.allowed_seats = make_adjacency(allowed);
+
+    return {make_adjacency(friends), make_adjacency(enemies), std::move(constraints), weights};
+}
+
+template<std::size_t NumStudents>
+std::vector<std::pair<std::size_t, std::size_t>> ClassEditor<NumStudents>::edited_pairs() const {
+    auto edited = pairs;
+
+    std::sort(edited.begin(), edited.end());
+    edited.erase(std::unique(edited.begin(), edited.end()), edited.end());
+
+    return edited;
+}
+
+template<std::size_t NumStudents, typename Names>
+bool parse_edits(std::string_view          input,
+                 Names&                    names,
+                 ClassEditor<NumStudents>& editor,
+                 ParseError&               error) {
+    std::string_view text = input;
+
+    const auto fail = [&](const char* position, std::string message) {
+        error = {line_of(input, position), std::move(message)};
+        return false;
+    };
+
+    const auto find = [&](std::string_view name) {
+        return static_cast<std::size_t>(std::find(names.begin(), names.end(), name) - names.begin());
+    };
+
+    while (!text.empty())
+    {
+        auto line = trim(next_field(text, '\n'));
+
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        const auto directive = next_token(line);
+        const auto first     = next_token(line);
+        const auto second    = next_token(line);
+        const bool single    = directive == "leave";
+
+        if (directive != "friend" && directive != "unfriend" && directive != "enemy"
+            && directive != "unenemy" && directive != "leave" && directive != "join")
+            return fail(directive.data(), "unknown edit '" + std::string(directive)
+                                            + "', expected friend, unfriend, enemy, unenemy,"
+                                              " leave or join");
+
+        if (first.empty() || single != second.empty() || !trim(line).empty())
+            return fail(directive.data(), single ? "expected 'leave name'"
+                                                 : "expected '" + std::string(directive)
+                                                     + " name other'");
+
+        if (directive == "join")
+        {
+            const auto seat = find(second);
+
+            if (find(first) != names.size())
+                return fail(first.data(), "'" + std::string(first) + "' is already seated");
+
+            if (seat == names.size())
+                return fail(second.data(), "unknown student '" + std::string(second) + "'");
+
+            if (!editor.is_vacant(seat))
+                return fail(second.data(), "the seat of '" + std::string(second)
+                                             + "' is not vacant");
+
+            names[seat] = first;
+            continue;
+        }
+
+        const auto student = find(first);
+
+        if (student == names.size())
+            return fail(first.data(), "unknown student '" + std::string(first) + "'");
+
+        if (single)
+        {
+            editor.vacate(student);
+            names[student] = "(" + names[student] + ")";
+            continue;
+        }
+
+        const auto other = find(second);
+
+        if (other == names.size())
+            return fail(second.data(), "unknown student '" + std::string(second) + "'");
+
+        if (other == student)
+            return fail(second.data(), "a student cannot be their own friend or enemy");
+
+        if (directive == "friend")
+            editor.add_friend(student, other);
+        else if (directive == "unfriend")
+            editor.remove_friend(student, other);
+        else if (directive == "enemy")
+            editor.add_enemy(student, other);
+        else
+            editor.remove_enemy(student, other);
+    }
+
+    return true;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+double edit_score_delta(const SeatingChart<Row, Column>&                     chart,
+                        const ClassInfo<Row * Column>&                       before,
+                        const ClassInfo<Row * Column>&                       after,
+                        std::span<const std::pair<std::size_t, std::size_t>> pairs,
+                        const Policy&                                        policy) {
+    const auto* inverse_distances = inverse_distances_of(chart, policy);
+
+    double delta = 0;
+
+    for (const auto& [first, second] : pairs)
+    {
+        const auto first_location  = chart.locations()[first];
+        const auto second_location = chart.locations()[second];
+        const auto closeness =
+          inverse_distances[seat_index(first_location, chart.columns()) * chart.size()
+                            + seat_index(second_location, chart.columns())];
+
+        delta += (after.distance_weight(first, second) - before.distance_weight(first, second))
+               * closeness;
+
+        if (same_table(policy, first_location, second_location))
+            delta +=
+              after.tablemate_weight(first, second) - before.tablemate_weight(first, second);
+    }
+
+    return delta;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+ReseatResult reseat(SeatingChart<Row, Column>&                           chart,
+                    ChartScorer<Row, Column, Policy>&                    scorer,
+                    const ClassInfo<Row * Column>&                       class_info,
+                    std::span<const std::pair<std::size_t, std::size_t>> pairs,
+                    double                                               score,
+                    std::size_t                                          radius) {
+    // Breadth-first out from the edited students, over the edited class's relationships
+    std::vector<bool>        reached(chart.size(), false);
+    std::vector<std::size_t> students;
+
+    for (const auto& [first, second] : pairs)
+    {
+        for (const auto student : {first, second})
+        {
+            if (!reached[student])
+            {
+                reached[student] = true;
+                students.push_back(student);
+            }
+        }
+    }
+
+    for (std::size_t hop = 0, begin = 0; hop < radius; hop++)
+    {
+        const auto end = students.size();
+
+        for (auto i = begin; i < end; i++)
+        {
+            for (const auto other : class_info.neighbours_of(students[i]))
+            {
+                if (!reached[other])
+                {
+                    reached[other] = true;
+                    students.push_back(other);
+                }
+            }
+        }
+
+        begin = end;
+    }
+
+    ReseatResult result{score, 0, students.size()};
+
+    for (double raise = chart.hill_climb_around(scorer, students); raise > 0;
+         raise        = chart.hill_climb_around(scorer, students))
+    {
+        result.score += raise;
+        result.moves++;
+    }
+
+    return result;
+}
+
+}
+
+#endif
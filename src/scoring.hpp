@@ -0,0 +1,132 @@
+#ifndef SCORING_HPP_INCLUDED
+#define SCORING_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+
+namespace SeatingChartGenetic {
+
+enum class DistanceKind {
+    Euclidean,
+    Manhattan,
+    Rows
+};
+
+// Distance kernels give the closeness of two distinct seats from how many rows and columns
+// lie between them; relationship weights are scaled by it.
+struct EuclideanDistance {
+    static constexpr DistanceKind kind = DistanceKind::Euclidean;
+
+    // 1/d^2 with d the straight-line distance
+    [[nodiscard]] static constexpr double closeness(std::size_t rows_apart,
+                                                    std::size_t columns_apart) noexcept {
+        return 1.0 / static_cast<double>(rows_apart * rows_apart + columns_apart * columns_apart);
+    }
+};
+
+struct ManhattanDistance {
+    static constexpr DistanceKind kind = DistanceKind::Manhattan;
+
+    // 1/d^2 with d the walk along rows and columns
+    [[nodiscard]] static constexpr double closeness(std::size_t rows_apart,
+                                                    std::size_t columns_apart) noexcept {
+        const auto steps = rows_apart + columns_apart;
+        return 1.0 / static_cast<double>(steps * steps);
+    }
+};
+
+struct RowDistance {
+    static constexpr DistanceKind kind = DistanceKind::Rows;
+
+    // Only rows count, a whole row being 1 apart, so where in a row a student sits is left
+    // to the tablemate terms
+    [[nodiscard]] static constexpr double closeness(std::size_t rows_apart, std::size_t) noexcept {
+        return 1.0 / static_cast<double>((rows_apart + 1) * (rows_apart + 1));
+    }
+};
+
+[[nodiscard]] constexpr double
+closeness(DistanceKind, std::size_t rows_apart, std::size_t columns_apart) noexcept;
+
+// A scoring policy fixes the room's geometry: tables are runs of table_seats() seats along
+// a row from its first column, so the columns must be a multiple of it (see fits_tables),
+// and distance() picks the kernel. StaticScoring fixes both at compile time, so the table
+// loops of the scorers unroll and fixed-size rooms read a constexpr closeness table;
+// RuntimeScoring reads them from the object, for trying layouts without a rebuild.
+template<std::size_t TableSeats, typename Distance>
+struct StaticScoring {
+    static_assert(TableSeats > 0);
+
+    using distance_type = Distance;
+
+    [[nodiscard]] static constexpr std::size_t  table_seats() noexcept { return TableSeats; }
+    [[nodiscard]] static constexpr DistanceKind distance() noexcept { return Distance::kind; }
+};
+
+// Two-seat tables and 1/d^2, the layout the weights were tuned for
+using DefaultScoring = StaticScoring<2, EuclideanDistance>;
+
+struct RuntimeScoring {
+    std::size_t  seats_per_table;
+    DistanceKind kind;
+
+    [[nodiscard]] constexpr std::size_t  table_seats() const noexcept { return seats_per_table; }
+    [[nodiscard]] constexpr DistanceKind distance() const noexcept { return kind; }
+};
+
+template<typename Policy>
+inline constexpr bool is_static_scoring = requires { typename Policy::distance_type; };
+
+// Seats per table of a StaticScoring, and 0 for policies that only know it at runtime
+template<typename Policy>
+inline constexpr std::size_t static_table_seats = 0;
+
+template<std::size_t TableSeats, typename Distance>
+inline constexpr std::size_t static_table_seats<StaticScoring<TableSeats, Distance>> = TableSeats;
+
+// Whether rows of `columns` seats divide into whole tables
+template<typename Policy>
+[[nodiscard]] constexpr bool fits_tables(const Policy&, std::size_t columns) noexcept;
+
+// First column of the table holding `column`, and one past its last
+template<typename Policy>
+[[nodiscard]] constexpr std::size_t table_begin(const Policy&, std::size_t column) noexcept;
+
+template<typename Policy>
+[[nodiscard]] constexpr std::size_t
+table_end(const Policy&, std::size_t column, std::size_t columns) noexcept;
+
+}
+
+namespace SeatingChartGenetic {
+
+constexpr double
+closeness(DistanceKind kind, std::size_t rows_apart, std::size_t columns_apart) noexcept {
+    if (kind == DistanceKind::Manhattan)
+        return ManhattanDistance::closeness(rows_apart, columns_apart);
+
+    if (kind == DistanceKind::Rows)
+        return RowDistance::closeness(rows_apart, columns_apart);
+
+    return EuclideanDistance::closeness(rows_apart, columns_apart);
+}
+
+template<typename Policy>
+constexpr bool fits_tables(const Policy& policy, std::size_t columns) noexcept {
+    return columns % policy.table_seats() == 0;
+}
+
+template<typename Policy>
+constexpr std::size_t table_begin(const Policy& policy, std::size_t column) noexcept {
+    return column - column % policy.table_seats();
+}
+
+template<typename Policy>
+constexpr std::size_t
+table_end(const Policy& policy, std::size_t column, std::size_t columns) noexcept {
+    return std::min(table_begin(policy, column) + policy.table_seats(), columns);
+}
+
+}
+
+#endif
@@ -4,10 +4,21 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <random>
+#include <span>
 #include <type_traits>
 #include <iostream>
+#include <vector>
+
+#include "anytime.hpp"
+#include "extent.hpp"
+#include "scoring.hpp"
+#include "stats.hpp"
+#include "tabu.hpp"
 
 namespace SeatingChartGenetic {
 
@@ -22,38 +33,125 @@ struct Move {
     bool        is_pair_swap;
 };
 
+// Smallest score change the climbers treat as an improvement; swap deltas are
+// accumulated in a different order than full rescoring and carry rounding noise.
+inline constexpr double ScoreTolerance = 1e-9;
+
+enum class CoolingSchedule {
+    Geometric,
+    Linear
+};
+
+struct AnnealingSchedule {
+    double          initial_temperature;
+    double          final_temperature;
+    std::size_t     steps;
+    CoolingSchedule cooling;
+};
+
+// Rules of a class without constraints at two-seat tables, the default for shuffles and
+// mutations. A scorer can be passed instead, and then every random swap that would break one
+// of the class's constraints is skipped and pair swaps follow its tables.
+struct NoConstraints {
+    [[nodiscard]] static constexpr bool constrained() noexcept { return false; }
+
+    [[nodiscard]] static constexpr DefaultScoring scoring() noexcept { return {}; }
+
+    template<typename Chart>
+    [[nodiscard]] static constexpr bool allows(const Chart&) noexcept {
+        return true;
+    }
+
+    template<typename Chart>
+    [[nodiscard]] static constexpr bool
+    allows_swap_students(const Chart&, std::size_t, std::size_t) noexcept {
+        return true;
+    }
+
+    template<typename Chart>
+    [[nodiscard]] static constexpr bool
+    allows_swap_pairs(const Chart&, std::size_t, std::size_t) noexcept {
+        return true;
+    }
+};
+
+// Row and Column are either both fixed or both Dynamic. The chart does not know the tables;
+// moves that depend on them take the seats per table from the scorer's policy, whose tables
+// must divide the columns (see fits_tables).
 template<std::size_t Row, std::size_t Column>
 class SeatingChart {
-    std::array<std::array<std::size_t, Column>, Row> seats_;
-    std::array<Location, Row * Column>               locations_;
+    static_assert((Row == Dynamic) == (Column == Dynamic));
+
+   public:
+    using seats_type = FixedOrDynamic<Row, FixedOrDynamic<Column, std::size_t>>;
+
+   private:
+    seats_type                             seats_;
+    FixedOrDynamic<Row * Column, Location> locations_;
 
     constexpr void swap_students(std::size_t, std::size_t) noexcept;
-    constexpr void swap_pairs(std::size_t, std::size_t) noexcept;
+    constexpr void swap_pairs(std::size_t, std::size_t, std::size_t) noexcept;
+    constexpr void apply(const Move&, std::size_t) noexcept;
+
+    template<typename Scorer, typename Visitor>
+    void for_each_move(Scorer&, Visitor&&);
+
+    [[nodiscard]] constexpr bool
+    is_canonical_pair_swap(std::size_t, std::size_t, std::size_t) const noexcept;
+
+    [[nodiscard]] constexpr std::size_t& seat(std::size_t) noexcept;
+    [[nodiscard]] constexpr const std::size_t& seat(std::size_t) const noexcept;
+
+    [[nodiscard]] static SeatingChart& scratch_copy(const SeatingChart&);
 
    public:
     template<typename T,
              typename = typename std::enable_if_t<
-               std::is_same_v<std::remove_reference_t<T>,
-                              std::array<std::array<std::size_t, Column>, Row>>,
+               std::is_same_v<std::remove_reference_t<T>, seats_type>,
                bool>>
     constexpr SeatingChart(T&&);
-    constexpr SeatingChart(const SeatingChart&) = default;
+    constexpr SeatingChart(const SeatingChart&)            = default;
+    constexpr SeatingChart(SeatingChart&&)                 = default;
+    constexpr SeatingChart& operator=(const SeatingChart&) = default;
+    constexpr SeatingChart& operator=(SeatingChart&&)      = default;
 
     [[nodiscard]] constexpr const auto&        seats() const noexcept { return seats_; }
     [[nodiscard]] constexpr const auto&        locations() const noexcept { return locations_; }
-    [[nodiscard]] static constexpr std::size_t tablemate_column(std::size_t column) noexcept {
-        return column - 2 * (column % 2) + 1;
+    [[nodiscard]] constexpr std::size_t        rows() const noexcept;
+    [[nodiscard]] constexpr std::size_t        columns() const noexcept;
+    [[nodiscard]] constexpr std::size_t        size() const noexcept { return rows() * columns(); }
+
+    // The seat after `column` around its table of `table_seats`, wrapping to the table's first;
+    // at two-seat tables the other seat, and at single seats the seat itself
+    [[nodiscard]] static constexpr std::size_t tablemate_column(std::size_t column,
+                                                                std::size_t table_seats) noexcept {
+        return column - column % table_seats + (column % table_seats + 1) % table_seats;
     }
-    [[nodiscard]] constexpr std::size_t get_tablemate(std::size_t) const noexcept;
+    [[nodiscard]] constexpr std::size_t get_tablemate(std::size_t, std::size_t) const noexcept;
+
+    template<typename PRNG, typename Rules = NoConstraints>
+    void random_shuffle(PRNG&, const Rules& = {});
+
+    template<typename PRNG, std::size_t Swaps, typename Rules = NoConstraints>
+    void partial_random_shuffle(PRNG&, const Rules& = {});
+
+    template<typename PRNG, typename PRNG::result_type probability, typename Rules = NoConstraints>
+    void probablistic_random_shuffle(PRNG&, const Rules& = {});
+
+    template<typename PRNG, typename Rules = NoConstraints>
+    void mutate(PRNG&, const Rules& = {});
+
+    template<typename PRNG, typename Rules = NoConstraints>
+    void mutate2(PRNG&, const Rules& = {});
 
     template<typename PRNG>
-    void random_shuffle(PRNG&);
+    [[nodiscard]] static SeatingChart crossover(const SeatingChart&, const SeatingChart&, PRNG&);
 
-    template<typename PRNG, std::size_t Swaps>
-    void partial_random_shuffle(PRNG&);
+    template<typename PRNG, typename Rules = NoConstraints>
+    void crossover_from(const SeatingChart&, const SeatingChart&, PRNG&, const Rules& = {});
 
-    template<typename PRNG, typename PRNG::result_type probability>
-    void probablistic_random_shuffle(PRNG&);
+    template<typename Constraints, typename Tables = DefaultScoring>
+    [[nodiscard]] bool seat_feasibly(const Constraints&, const Tables& = {});
 
     template<typename Scorer>
     bool hill_climb_students(Scorer&);
@@ -61,11 +159,24 @@ class SeatingChart {
     template<typename Scorer>
     bool hill_climb_pairs(Scorer&);
 
+    // The climbers, annealing and tabu search return early once `stop` asks, leaving the chart
+    // at the best arrangement they had reached
     template<typename Scorer>
-    bool hill_climb_combined(Scorer&);
+    bool hill_climb_combined(Scorer&, const StopToken& stop = {});
 
+    template<typename Scorer, std::size_t Width = 8>
+    bool hill_climb_lookahead(Scorer&, const StopToken& stop = {});
+
+    // One hill_climb_combined step limited to moves of the given students, for re-seating
+    // around a small edit to the class. Returns the raise, or 0 when no such move has one.
     template<typename Scorer>
-    bool hill_climb_lookahead(Scorer&);
+    double hill_climb_around(Scorer&, std::span<const std::size_t>);
+
+    template<typename Scorer, typename PRNG>
+    double anneal(Scorer&, const AnnealingSchedule&, PRNG&, const StopToken& stop = {});
+
+    template<typename Scorer>
+    double tabu_search(Scorer&, const TabuSettings&, const StopToken& stop = {});
 };
 
 }
@@ -75,17 +186,34 @@ namespace SeatingChartGenetic {
 template<std::size_t Row, std::size_t Column>
 template<typename T, typename>
 constexpr SeatingChart<Row, Column>::SeatingChart(T&& c) :
-    seats_(std::forward<T>(c)) {
-    for (std::size_t i = 0; i < Row; i++)
-        for (std::size_t j = 0; j < Column; j++)
+    seats_(std::forward<T>(c)),
+    locations_{make_fixed_or_dynamic<Row * Column, Location>(size())} {
+    for (std::size_t i = 0; i < rows(); i++)
+        for (std::size_t j = 0; j < columns(); j++)
             locations_[seats_[i][j]] = {i, j};
 }
 
+template<std::size_t Row, std::size_t Column>
+constexpr std::size_t SeatingChart<Row, Column>::rows() const noexcept {
+    if constexpr (Row == Dynamic)
+        return seats_.size();
+    else
+        return Row;
+}
+
+template<std::size_t Row, std::size_t Column>
+constexpr std::size_t SeatingChart<Row, Column>::columns() const noexcept {
+    if constexpr (Column == Dynamic)
+        return seats_.empty() ? 0 : seats_.front().size();
+    else
+        return Column;
+}
+
 template<std::size_t Row, std::size_t Column>
 constexpr void SeatingChart<Row, Column>::swap_students(std::size_t first,
                                                         std::size_t second) noexcept {
     using std::swap;
-    assert(first >= 0 && first < Row * Column && second >= 0 && first < Row * Column);
+    assert(first < size() && second < size());
     const auto [first_row, first_column]   = locations_[first];
     const auto [second_row, second_column] = locations_[second];
 
@@ -93,101 +221,396 @@ constexpr void SeatingChart<Row, Column>::swap_students(std::size_t first,
     swap(locations_[first], locations_[second]);
 }
 
+// Swaps two students and then their tablemates, which moves whole tables when they seat two.
+// Either way the second swap finds the same two tablemates, so the move is an involution.
 template<std::size_t Row, std::size_t Column>
 constexpr void SeatingChart<Row, Column>::swap_pairs(std::size_t first,
-                                                     std::size_t second) noexcept {
+                                                     std::size_t second,
+                                                     std::size_t table_seats) noexcept {
     swap_students(first, second);
-    swap_students(get_tablemate(first), get_tablemate(second));
+    swap_students(get_tablemate(first, table_seats), get_tablemate(second, table_seats));
+}
+
+// At two-seat tables, swapping the pairs of i and j moves the same students as swapping those
+// of their tablemates, and swapping a student's pair with itself moves nobody. Of the unordered
+// pairs {i, j} and {mate(i), mate(j)} only the one holding the lowest student is canonical,
+// which also rules out the second case, where both name the same two students. Larger tables
+// have neither duplicate, as a student's tablemate's tablemate is someone else.
+template<std::size_t Row, std::size_t Column>
+constexpr bool
+SeatingChart<Row, Column>::is_canonical_pair_swap(std::size_t first,
+                                                  std::size_t second,
+                                                  std::size_t table_seats) const noexcept {
+    return table_seats != 2
+        || std::min(first, second)
+             < std::min(get_tablemate(first, table_seats), get_tablemate(second, table_seats));
+}
+
+// Both swaps are involutions, so applying a move twice restores the chart
+template<std::size_t Row, std::size_t Column>
+constexpr void SeatingChart<Row, Column>::apply(const Move& move,
+                                                std::size_t table_seats) noexcept {
+    if (move.is_pair_swap)
+        swap_pairs(move.student1, move.student2, table_seats);
+    else
+        swap_students(move.student1, move.student2);
 }
 
 template<std::size_t Row, std::size_t Column>
-constexpr std::size_t SeatingChart<Row, Column>::get_tablemate(std::size_t student) const noexcept {
+constexpr std::size_t
+SeatingChart<Row, Column>::get_tablemate(std::size_t student,
+                                         std::size_t table_seats) const noexcept {
     const auto [row, column] = locations_[student];
-    return seats_[row][tablemate_column(column)];
+    assert(column - column % table_seats + table_seats <= columns());
+    return seats_[row][tablemate_column(column, table_seats)];
 }
 
+// Student in a seat numbered row-major
 template<std::size_t Row, std::size_t Column>
-template<typename PRNG>
-void SeatingChart<Row, Column>::random_shuffle(PRNG& prng) {
-    using std::begin, std::end;
+constexpr std::size_t& SeatingChart<Row, Column>::seat(std::size_t index) noexcept {
+    return seats_[index / columns()][index % columns()];
+}
+
+template<std::size_t Row, std::size_t Column>
+constexpr const std::size_t& SeatingChart<Row, Column>::seat(std::size_t index) const noexcept {
+    return seats_[index / columns()][index % columns()];
+}
+
+// A per-thread chart holding a copy of `chart`, for searches that remember their best
+// arrangement. Copy assignment reuses its storage, so runtime-sized charts allocate only on a
+// thread's first call.
+template<std::size_t Row, std::size_t Column>
+SeatingChart<Row, Column>& SeatingChart<Row, Column>::scratch_copy(const SeatingChart& chart) {
+    thread_local SeatingChart scratch{chart};
+
+    scratch = chart;
+    return scratch;
+}
 
-    std::array<std::size_t, Row * Column> temp;
+// Fisher-Yates over the row-major seats, in place. Under constraints every exchange that
+// would break one is skipped, so a chart that keeps them still does afterwards.
+template<std::size_t Row, std::size_t Column>
+template<typename PRNG, typename Rules>
+void SeatingChart<Row, Column>::random_shuffle(PRNG& prng, const Rules& rules) {
+    using std::swap;
+    using distribution_type = std::uniform_int_distribution<typename PRNG::result_type>;
 
-    for (std::size_t i = 0; i < Row; i++)
-        for (std::size_t j = 0; j < Column; j++)
-            temp[i * Column + j] = seats_[i][j];
+    if (rules.constrained())
+    {
+        for (std::size_t i = size() - 1; i > 0; i--)
+        {
+            distribution_type gen_seat{0, i};
+
+            const auto first  = seat(i);
+            const auto second = seat(gen_seat(prng));
+
+            if (rules.allows_swap_students(*this, first, second))
+                swap_students(first, second);
+        }
 
-    std::shuffle(begin(temp), end(temp), prng);
+        return;
+    }
 
-    for (std::size_t i = 0; i < Row; i++)
-        for (std::size_t j = 0; j < Column; j++)
-            seats_[i][j] = temp[i * Column + j];
+    for (std::size_t i = size() - 1; i > 0; i--)
+    {
+        distribution_type gen_seat{0, i};
+        swap(seat(i), seat(gen_seat(prng)));
+    }
 
-    for (std::size_t i = 0; i < Row; i++)
-        for (std::size_t j = 0; j < Column; j++)
+    for (std::size_t i = 0; i < rows(); i++)
+        for (std::size_t j = 0; j < columns(); j++)
             locations_[seats_[i][j]] = {i, j};
 }
 
 template<std::size_t Row, std::size_t Column>
-template<typename PRNG, std::size_t Swaps>
-void SeatingChart<Row, Column>::partial_random_shuffle(PRNG& prng) {
+template<typename PRNG, std::size_t Swaps, typename Rules>
+void SeatingChart<Row, Column>::partial_random_shuffle(PRNG& prng, const Rules& rules) {
     using distribution_type = std::uniform_int_distribution<typename PRNG::result_type>;
-    static_assert(Swaps <= Row * Column);
+    static_assert(Row == Dynamic || Swaps <= Row * Column);
 
-    distribution_type gen_student{0, Row - 1};
+    // Runtime-sized rooms can have fewer seats than swaps
+    const auto swaps = std::min(Swaps, size());
+
+    distribution_type gen_student{0, rows() - 1};
     distribution_type coin_flip{0, 1};
 
+    const auto try_swap = [&](const std::size_t student) {
+        const auto other = gen_student(prng);
+
+        if (rules.allows_swap_students(*this, student, other))
+            swap_students(student, other);
+    };
+
     if (coin_flip(prng))
-        for (std::size_t i = 0; i < Swaps; i++)
-            swap_students(i, gen_student(prng));
+        for (std::size_t i = 0; i < swaps; i++)
+            try_swap(i);
     else
-        for (std::size_t i = Row * Column - 1; i >= Row * Column - Swaps; i--)
-            swap_students(i, gen_student(prng));
+        for (std::size_t i = size(); i-- > size() - swaps;)
+            try_swap(i);
 }
 
 template<std::size_t Row, std::size_t Column>
-template<typename PRNG, typename PRNG::result_type probability>
-void SeatingChart<Row, Column>::probablistic_random_shuffle(PRNG& prng) {
+template<typename PRNG, typename PRNG::result_type probability, typename Rules>
+void SeatingChart<Row, Column>::probablistic_random_shuffle(PRNG& prng, const Rules& rules) {
     using distribution_type = std::uniform_int_distribution<typename PRNG::result_type>;
     static_assert(probability <= 1000);
     static_assert(probability > 0);
 
-    distribution_type gen_student{0, Row - 1};
+    distribution_type gen_student{0, rows() - 1};
     distribution_type gen_probablistic{0, 1000};
 
-    for (std::size_t i = 0; i < Row * Column; i++)
+    for (std::size_t i = 0; i < size(); i++)
+    {
         if (gen_probablistic(prng) > probability)
-            swap_students(i, gen_student(prng));
+        {
+            const auto other = gen_student(prng);
+
+            if (rules.allows_swap_students(*this, i, other))
+                swap_students(i, other);
+        }
+    }
+}
+
+template<std::size_t Row, std::size_t Column>
+template<typename PRNG, typename Rules>
+void SeatingChart<Row, Column>::mutate(PRNG& prng, const Rules& rules) {
+    using distribution_type = std::uniform_int_distribution<typename PRNG::result_type>;
+
+    distribution_type gen_student{0, size() - 1};
+
+    const auto first  = gen_student(prng);
+    const auto second = gen_student(prng);
+
+    if (rules.allows_swap_students(*this, first, second))
+        swap_students(first, second);
+}
+
+template<std::size_t Row, std::size_t Column>
+template<typename PRNG, typename Rules>
+void SeatingChart<Row, Column>::mutate2(PRNG& prng, const Rules& rules) {
+    using distribution_type = std::uniform_int_distribution<typename PRNG::result_type>;
+
+    distribution_type gen_student{0, size() - 1};
+
+    const auto first  = gen_student(prng);
+    const auto second = gen_student(prng);
+
+    if (rules.allows_swap_pairs(*this, first, second))
+        swap_pairs(first, second, rules.scoring().table_seats());
+}
+
+// Order crossover (OX) over the row-major seat sequence: the child keeps a random run of seats
+// from `first` and fills the remaining seats, wrapping around, with the other students in the
+// order they appear in `second`. The result is always a valid permutation.
+template<std::size_t Row, std::size_t Column>
+template<typename PRNG>
+SeatingChart<Row, Column> SeatingChart<Row, Column>::crossover(const SeatingChart& first,
+                                                               const SeatingChart& second,
+                                                               PRNG&               prng) {
+    SeatingChart child{first};
+    child.crossover_from(first, second, prng);
+    return child;
+}
+
+// Order crossover into this chart, which must have the parents' size and must not be either
+// parent. Its storage is reused, so breeding into a preallocated population does not allocate.
+// A child that breaks a constraint is replaced by a copy of `first`.
+template<std::size_t Row, std::size_t Column>
+template<typename PRNG, typename Rules>
+void SeatingChart<Row, Column>::crossover_from(const SeatingChart& first,
+                                               const SeatingChart& second,
+                                               PRNG&               prng,
+                                               const Rules&        rules) {
+    using distribution_type = std::uniform_int_distribution<typename PRNG::result_type>;
+    assert(this != &first && this != &second && size() == first.size());
+
+    const auto seat_count = size();
+
+    distribution_type gen_seat{0, seat_count - 1};
+
+    auto segment_begin = gen_seat(prng);
+    auto segment_end   = gen_seat(prng);
+
+    if (segment_begin > segment_end)
+        std::swap(segment_begin, segment_end);
+
+    segment_end++;
+
+    // A student is already placed exactly when `first` seats them inside the segment
+    const auto placed = [&](const std::size_t student) {
+        const auto [row, column] = first.locations_[student];
+        const auto index         = row * columns() + column;
+        return index >= segment_begin && index < segment_end;
+    };
+
+    const auto place = [&](const std::size_t index, const std::size_t student) {
+        seat(index)         = student;
+        locations_[student] = {index / columns(), index % columns()};
+    };
+
+    for (std::size_t index = segment_begin; index < segment_end; index++)
+        place(index, first.seat(index));
+
+    std::size_t donor_seat = segment_end % seat_count;
+
+    for (std::size_t offset = 0; offset < seat_count - (segment_end - segment_begin); offset++)
+    {
+        while (placed(second.seat(donor_seat)))
+            donor_seat = (donor_seat + 1) % seat_count;
+
+        place((segment_end + offset) % seat_count, second.seat(donor_seat));
+        donor_seat = (donor_seat + 1) % seat_count;
+    }
+
+    if (rules.constrained() && !rules.allows(*this))
+        *this = first;
+}
+
+// Rearranges the chart to keep every constraint of the class, moving few students: those with
+// seat rules are matched to allowed seats by augmenting paths, trying their current seats
+// first; everyone else keeps their seat while it is free; then each table holding a pair kept
+// apart is split by an allowed swap. Returns false if no arrangement was found.
+template<std::size_t Row, std::size_t Column>
+template<typename Constraints, typename Tables>
+bool SeatingChart<Row, Column>::seat_feasibly(const Constraints& class_info, const Tables& tables) {
+    constexpr std::size_t Unassigned = std::numeric_limits<std::size_t>::max();
+
+    if (class_info.allows(*this, tables))
+        return true;
+
+    const auto seat_of = [&](const std::size_t student) {
+        return locations_[student].row * columns() + locations_[student].column;
+    };
+
+    std::vector<std::size_t> holder(size(), Unassigned);
+    std::vector<char>        visited(size());
+
+    const auto augment = [&](const auto& self, const std::size_t student) -> bool {
+        const auto try_seat = [&](const std::size_t seat) {
+            if (visited[seat] || !class_info.may_sit(student, seat))
+                return false;
+
+            visited[seat] = true;
+
+            if (holder[seat] != Unassigned && !self(self, holder[seat]))
+                return false;
+
+            holder[seat] = student;
+            return true;
+        };
+
+        if (try_seat(seat_of(student)))
+            return true;
+
+        for (const auto seat : class_info.allowed_seats_of(student))
+            if (try_seat(seat))
+                return true;
+
+        return false;
+    };
+
+    for (std::size_t student = 0; student < size(); student++)
+    {
+        if (class_info.allowed_seats_of(student).empty())
+            continue;
+
+        std::fill(visited.begin(), visited.end(), false);
+
+        if (!augment(augment, student))
+            return false;
+    }
+
+    std::vector<char> placed(size());
+
+    for (const auto student : holder)
+        if (student != Unassigned)
+            placed[student] = true;
+
+    for (std::size_t student = 0; student < size(); student++)
+    {
+        if (!placed[student] && holder[seat_of(student)] == Unassigned)
+        {
+            holder[seat_of(student)] = student;
+            placed[student]          = true;
+        }
+    }
+
+    std::size_t free_seat = 0;
+
+    for (std::size_t student = 0; student < size(); student++)
+    {
+        if (placed[student])
+            continue;
+
+        while (holder[free_seat] != Unassigned)
+            free_seat++;
+
+        holder[free_seat] = student;
+    }
+
+    for (std::size_t index = 0; index < size(); index++)
+    {
+        seat(index)               = holder[index];
+        locations_[holder[index]] = {index / columns(), index % columns()};
+    }
+
+    // A swap within the table is allowed but does not help, so it is undone
+    for (std::size_t student = 0; student < size(); student++)
+    {
+        for (std::size_t other = 0; other < size() && !class_info.sits_apart(*this, student, tables);
+             other++)
+        {
+            if (other == student || !class_info.allows_swap_students(*this, student, other, tables))
+                continue;
+
+            swap_students(student, other);
+
+            if (!class_info.sits_apart(*this, student, tables))
+                swap_students(student, other);
+        }
+
+        if (!class_info.sits_apart(*this, student, tables))
+            return false;
+    }
+
+    return class_info.allows(*this, tables);
 }
 
 template<std::size_t Row, std::size_t Column>
 template<typename Scorer>
 bool SeatingChart<Row, Column>::hill_climb_students(Scorer& scorer) {
-    double maximum_score = scorer(*this);
-    bool   found_raise   = false;
+    double        maximum_delta = ScoreTolerance;
+    bool          found_raise   = false;
+    std::uint64_t scored        = 0;
 
     std::pair<std::size_t, std::size_t> best_swap;
 
-    for (std::size_t i = 0; i < Row * Column; i++)
+    for (std::size_t i = 0; i < size(); i++)
     {
-        for (std::size_t j = i + 1; j < Row * Column; j++)
+        for (std::size_t j = i + 1; j < size(); j++)
         {
-            swap_students(i, j);
+            if (!scorer.allows_swap_students(*this, i, j))
+                continue;
 
-            const double curr_score = scorer(*this);
+            const double curr_delta = scorer.swap_students_delta(*this, i, j);
+            scored++;
 
-            if (curr_score > maximum_score)
+            if (curr_delta > maximum_delta)
             {
-                maximum_score = curr_score;
+                maximum_delta = curr_delta;
                 found_raise   = true;
                 best_swap     = std::make_pair(i, j);
             }
-
-            swap_students(i, j);
         }
     }
 
-    swap_students(best_swap.first, best_swap.second);
+    count(StatCounter::MovesEvaluated, scored);
+
+    if (found_raise)
+    {
+        swap_students(best_swap.first, best_swap.second);
+        count(StatCounter::MovesAccepted);
+    }
 
     return found_raise;
 }
@@ -195,92 +618,434 @@ bool SeatingChart<Row, Column>::hill_climb_students(Scorer& scorer) {
 template<std::size_t Row, std::size_t Column>
 template<typename Scorer>
 bool SeatingChart<Row, Column>::hill_climb_pairs(Scorer& scorer) {
-    double maximum_score = scorer(*this);
-    bool   found_raise   = false;
+    const auto    table_seats   = scorer.scoring().table_seats();
+    double        maximum_delta = ScoreTolerance;
+    bool          found_raise   = false;
+    std::uint64_t scored        = 0;
 
     std::pair<std::size_t, std::size_t> best_swap;
 
-    for (std::size_t i = 0; i < Row * Column; i++)
+    for (std::size_t i = 0; i < size(); i++)
     {
-        for (std::size_t j = i + 1; j < Row * Column; j++)
+        for (std::size_t j = i + 1; j < size(); j++)
         {
-            swap_pairs(i, j);
+            if (!scorer.allows_swap_pairs(*this, i, j)
+                || !is_canonical_pair_swap(i, j, table_seats))
+                continue;
 
-            const double curr_score = scorer(*this);
+            const double curr_delta = scorer.swap_pairs_delta(*this, i, j);
+            scored++;
 
-            if (curr_score > maximum_score)
+            if (curr_delta > maximum_delta)
             {
-                maximum_score = curr_score;
+                maximum_delta = curr_delta;
                 found_raise   = true;
                 best_swap     = std::make_pair(i, j);
             }
-
-            swap_pairs(i, j);
         }
     }
 
-    swap_pairs(best_swap.first, best_swap.second);
+    count(StatCounter::MovesEvaluated, scored);
+
+    if (found_raise)
+    {
+        swap_pairs(best_swap.first, best_swap.second, table_seats);
+        count(StatCounter::MovesAccepted);
+    }
 
     return found_raise;
 }
 
 template<std::size_t Row, std::size_t Column>
 template<typename Scorer>
-bool SeatingChart<Row, Column>::hill_climb_combined(Scorer& scorer) {
-    double maximum_score = scorer(*this);
-    bool   found_raise   = false;
+bool SeatingChart<Row, Column>::hill_climb_combined(Scorer& scorer, const StopToken& stop) {
+    const auto    table_seats   = scorer.scoring().table_seats();
+    double        maximum_delta = ScoreTolerance;
+    bool          found_raise   = false;
+    std::uint64_t scored        = 0;
 
     Move best_swap;
 
-    for (std::size_t i = 0; i < Row * Column; i++)
+    // A stopped scan still takes the best raise it has seen
+    for (std::size_t i = 0; i < size() && !stop.stop_requested(); i++)
     {
-        for (std::size_t j = i + 1; j < Row * Column; j++)
+        for (std::size_t j = i + 1; j < size(); j++)
         {
-            swap_students(i, j);
+            if (!scorer.allows_swap_students(*this, i, j))
+                continue;
 
-            const double curr_score = scorer(*this);
+            const double curr_delta = scorer.swap_students_delta(*this, i, j);
+            scored++;
 
-            if (curr_score > maximum_score)
+            if (curr_delta > maximum_delta)
             {
-                maximum_score = curr_score;
+                maximum_delta = curr_delta;
                 found_raise   = true;
                 best_swap     = {i, j, false};
             }
-
-            swap_students(i, j);
         }
     }
 
-    for (std::size_t i = 0; i < Row * Column; i++)
+    for (std::size_t i = 0; i < size() && !stop.stop_requested(); i++)
     {
-        for (std::size_t j = i + 1; j < Row * Column; j++)
+        for (std::size_t j = i + 1; j < size(); j++)
         {
-            swap_pairs(i, j);
+            if (!scorer.allows_swap_pairs(*this, i, j)
+                || !is_canonical_pair_swap(i, j, table_seats))
+                continue;
 
-            const double curr_score = scorer(*this);
+            const double curr_delta = scorer.swap_pairs_delta(*this, i, j);
+            scored++;
 
-            if (curr_score > maximum_score)
+            if (curr_delta > maximum_delta)
             {
-                maximum_score = curr_score;
+                maximum_delta = curr_delta;
                 found_raise   = true;
                 best_swap     = {i, j, true};
             }
-
-            swap_pairs(i, j);
         }
     }
 
+    count(StatCounter::MovesEvaluated, scored);
+
     if (found_raise)
     {
         if (best_swap.is_pair_swap)
-            swap_pairs(best_swap.student1, best_swap.student2);
+            swap_pairs(best_swap.student1, best_swap.student2, table_seats);
         else
             swap_students(best_swap.student1, best_swap.student2);
+
+        count(StatCounter::MovesAccepted);
     }
 
     return found_raise;
 }
 
+template<std::size_t Row, std::size_t Column>
+template<typename Scorer>
+double SeatingChart<Row, Column>::hill_climb_around(Scorer&                      scorer,
+                                                    std::span<const std::size_t> students) {
+    const auto    table_seats   = scorer.scoring().table_seats();
+    double        maximum_delta = ScoreTolerance;
+    bool          found_raise   = false;
+    std::uint64_t scored        = 0;
+
+    Move best_swap;
+
+    for (const auto i : students)
+    {
+        for (std::size_t j = 0; j < size(); j++)
+        {
+            if (j == i)
+                continue;
+
+            if (scorer.allows_swap_students(*this, i, j))
+            {
+                const double curr_delta = scorer.swap_students_delta(*this, i, j);
+                scored++;
+
+                if (curr_delta > maximum_delta)
+                {
+                    maximum_delta = curr_delta;
+                    found_raise   = true;
+                    best_swap     = {i, j, false};
+                }
+            }
+
+            if (scorer.allows_swap_pairs(*this, i, j))
+            {
+                const double curr_delta = scorer.swap_pairs_delta(*this, i, j);
+                scored++;
+
+                if (curr_delta > maximum_delta)
+                {
+                    maximum_delta = curr_delta;
+                    found_raise   = true;
+                    best_swap     = {i, j, true};
+                }
+            }
+        }
+    }
+
+    count(StatCounter::MovesEvaluated, scored);
+
+    if (!found_raise)
+        return 0;
+
+    if (best_swap.is_pair_swap)
+        swap_pairs(best_swap.student1, best_swap.student2, table_seats);
+    else
+        swap_students(best_swap.student1, best_swap.student2);
+
+    count(StatCounter::MovesAccepted);
+    return maximum_delta;
+}
+
+// Calls `visit(move, delta)` for every allowed student and pair swap that can change the score.
+// Swaps in which no moved student has a relationship are skipped: their delta is always zero.
+// So are all but the canonical one of each set of pair swaps that move the same students.
+template<std::size_t Row, std::size_t Column>
+template<typename Scorer, typename Visitor>
+void SeatingChart<Row, Column>::for_each_move(Scorer& scorer, Visitor&& visit) {
+    const auto    table_seats = scorer.scoring().table_seats();
+    std::uint64_t evaluated   = 0;
+
+    for (std::size_t i = 0; i < size(); i++)
+    {
+        for (std::size_t j = i + 1; j < size(); j++)
+        {
+            const bool students_related =
+              scorer.has_relationships(i) || scorer.has_relationships(j);
+
+            if (students_related && scorer.allows_swap_students(*this, i, j))
+            {
+                visit(Move{i, j, false}, scorer.swap_students_delta(*this, i, j));
+                evaluated++;
+            }
+
+            if (scorer.allows_swap_pairs(*this, i, j) && is_canonical_pair_swap(i, j, table_seats)
+                && (students_related || scorer.has_relationships(get_tablemate(i, table_seats))
+                    || scorer.has_relationships(get_tablemate(j, table_seats))))
+            {
+                visit(Move{i, j, true}, scorer.swap_pairs_delta(*this, i, j));
+                evaluated++;
+            }
+        }
+    }
+
+    count(StatCounter::MovesEvaluated, evaluated);
+}
+
+// Steepest ascent over compound moves of one or two swaps. The Width best single moves,
+// improving or not, are each tried as a first move and followed by the best reply over the
+// whole neighbourhood, so one step costs about Width + 1 hill_climb_combined scans. This
+// escapes optima where no single swap helps but a pair of swaps does.
+template<std::size_t Row, std::size_t Column>
+template<typename Scorer, std::size_t Width>
+bool SeatingChart<Row, Column>::hill_climb_lookahead(Scorer& scorer, const StopToken& stop) {
+    static_assert(Width > 0);
+
+    const auto table_seats = scorer.scoring().table_seats();
+
+    std::array<std::pair<double, Move>, Width> candidates;
+    std::size_t                                candidate_count = 0;
+
+    for_each_move(scorer, [&](const Move& move, const double delta) {
+        if (candidate_count == Width && delta <= candidates.back().first)
+            return;
+
+        auto position = std::min(candidate_count, Width - 1);
+
+        for (; position > 0 && candidates[position - 1].first < delta; position--)
+            candidates[position] = candidates[position - 1];
+
+        candidates[position] = {delta, move};
+        candidate_count      = std::min(candidate_count + 1, Width);
+    });
+
+    double maximum_delta = ScoreTolerance;
+    bool   found_raise   = false;
+    bool   has_reply     = false;
+
+    Move best_first;
+    Move best_reply;
+
+    for (std::size_t c = 0; c < candidate_count && !stop.stop_requested(); c++)
+    {
+        const auto& [first_delta, first] = candidates[c];
+
+        if (first_delta > maximum_delta)
+        {
+            maximum_delta = first_delta;
+            found_raise   = true;
+            has_reply     = false;
+            best_first    = first;
+        }
+
+        apply(first, table_seats);
+
+        for_each_move(scorer, [&](const Move& reply, const double reply_delta) {
+            if (first_delta + reply_delta > maximum_delta)
+            {
+                maximum_delta = first_delta + reply_delta;
+                found_raise   = true;
+                has_reply     = true;
+                best_first    = first;
+                best_reply    = reply;
+            }
+        });
+
+        apply(first, table_seats);
+    }
+
+    if (found_raise)
+    {
+        apply(best_first, table_seats);
+
+        if (has_reply)
+            apply(best_reply, table_seats);
+
+        count(StatCounter::MovesAccepted, has_reply ? 2 : 1);
+    }
+
+    return found_raise;
+}
+
+// Simulated annealing over single student or pair swaps. Each step samples one move, scores it
+// with the scorer's swap delta and accepts it by the Metropolis criterion at the current
+// temperature. The chart is left at the best arrangement seen, whose score is returned.
+template<std::size_t Row, std::size_t Column>
+template<typename Scorer, typename PRNG>
+double SeatingChart<Row, Column>::anneal(Scorer&                  scorer,
+                                         const AnnealingSchedule& schedule,
+                                         PRNG&                    prng,
+                                         const StopToken&         stop) {
+    constexpr std::size_t StopPollSteps = 256;
+
+    using distribution_type = std::uniform_int_distribution<typename PRNG::result_type>;
+    assert(schedule.initial_temperature >= schedule.final_temperature
+           && schedule.final_temperature > 0);
+
+    distribution_type                      gen_student{0, size() - 1};
+    distribution_type                      coin_flip{0, 1};
+    std::uniform_real_distribution<double> gen_probability{0.0, 1.0};
+
+    const double cooling_factor =
+      std::pow(schedule.final_temperature / schedule.initial_temperature, 1.0 / schedule.steps);
+    const double cooling_decrement =
+      (schedule.initial_temperature - schedule.final_temperature) / schedule.steps;
+
+    double        temperature   = schedule.initial_temperature;
+    double        current_score = scorer(*this);
+    double        best_score    = current_score;
+    SeatingChart& best_chart    = scratch_copy(*this);
+    std::uint64_t scored        = 0;
+    std::uint64_t accepted      = 0;
+
+    for (std::size_t step = 0; step < schedule.steps; step++)
+    {
+        if (step % StopPollSteps == 0 && stop.stop_requested())
+            break;
+
+        const Move move{gen_student(prng), gen_student(prng), coin_flip(prng) == 1};
+
+        // A move that breaks a constraint is rejected without being scored
+        const bool allowed =
+          move.is_pair_swap ? scorer.allows_swap_pairs(*this, move.student1, move.student2)
+                            : scorer.allows_swap_students(*this, move.student1, move.student2);
+
+        double delta = 0;
+
+        if (allowed)
+        {
+            delta = move.is_pair_swap
+                    ? scorer.swap_pairs_delta(*this, move.student1, move.student2)
+                    : scorer.swap_students_delta(*this, move.student1, move.student2);
+            scored++;
+        }
+
+        if (allowed && (delta >= 0 || gen_probability(prng) < std::exp(delta / temperature)))
+        {
+            if (move.is_pair_swap)
+                swap_pairs(move.student1, move.student2, scorer.scoring().table_seats());
+            else
+                swap_students(move.student1, move.student2);
+
+            current_score += delta;
+            accepted++;
+
+            if (current_score > best_score + ScoreTolerance)
+            {
+                best_score = current_score;
+                best_chart = *this;
+            }
+        }
+
+        if (schedule.cooling == CoolingSchedule::Geometric)
+            temperature *= cooling_factor;
+        else
+            temperature -= cooling_decrement;
+    }
+
+    *this = best_chart;
+
+    count(StatCounter::MovesEvaluated, scored);
+    count(StatCounter::MovesAccepted, accepted);
+
+    // The running score accumulates rounding from every accepted delta
+    return scorer(*this);
+}
+
+// Tabu search: every iteration takes the best admissible move, even a worsening one, and
+// forbids swapping the moved students back for `tenure` iterations. A tabu move is still
+// admissible when it would beat the best score seen (aspiration). The chart is left at the
+// best arrangement seen, whose score is returned.
+template<std::size_t Row, std::size_t Column>
+template<typename Scorer>
+double SeatingChart<Row, Column>::tabu_search(Scorer&             scorer,
+                                              const TabuSettings& settings,
+                                              const StopToken&    stop) {
+    thread_local TabuList<Row * Column> tabu_list{size()};
+    tabu_list.reset(size());
+
+    const auto table_seats = scorer.scoring().table_seats();
+
+    double        current_score = scorer(*this);
+    double        best_score    = current_score;
+    SeatingChart& best_chart    = scratch_copy(*this);
+
+    for (std::size_t iteration = 0; iteration < settings.iterations && !stop.stop_requested();
+         iteration++)
+    {
+        double maximum_delta = std::numeric_limits<double>::lowest();
+        bool   found_move    = false;
+        Move   best_move;
+
+        for_each_move(scorer, [&](const Move& move, const double delta) {
+            if (delta <= maximum_delta)
+                return;
+
+            const bool is_tabu =
+              tabu_list.is_tabu(move.student1, move.student2, iteration)
+              || (move.is_pair_swap
+                  && tabu_list.is_tabu(get_tablemate(move.student1, table_seats),
+                                       get_tablemate(move.student2, table_seats), iteration));
+
+            if (is_tabu && current_score + delta <= best_score + ScoreTolerance)
+                return;
+
+            maximum_delta = delta;
+            found_move    = true;
+            best_move     = move;
+        });
+
+        if (!found_move)
+            break;
+
+        const auto release = iteration + settings.tenure + 1;
+
+        tabu_list.forbid(best_move.student1, best_move.student2, release);
+
+        if (best_move.is_pair_swap)
+            tabu_list.forbid(get_tablemate(best_move.student1, table_seats),
+                             get_tablemate(best_move.student2, table_seats), release);
+
+        apply(best_move, table_seats);
+        current_score += maximum_delta;
+        count(StatCounter::MovesAccepted);
+
+        if (current_score > best_score + ScoreTolerance)
+        {
+            best_score = current_score;
+            best_chart = *this;
+        }
+    }
+
+    *this = best_chart;
+
+    return scorer(*this);
+}
+
 }
 
 #endif
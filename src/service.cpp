@@ -0,0 +1,579 @@
+#include "service.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SeatingChartGenetic {
+
+namespace {
+
+struct Request {
+    std::string op, id, roster;
+    JobLimits   limits;
+};
+
+void skip_space(std::string_view& text) {
+    while (!text.empty()
+           && (text.front() == ' ' || text.front() == '\t' || text.front() == '\r'
+               || text.front() == '\n'))
+        text.remove_prefix(1);
+}
+
+void append_utf8(std::string& value, std::uint32_t code) {
+    if (code < 0x80)
+        value += static_cast<char>(code);
+    else if (code < 0x800)
+    {
+        value += static_cast<char>(0xc0 | (code >> 6));
+        value += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000)
+    {
+        value += static_cast<char>(0xe0 | (code >> 12));
+        value += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        value += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else
+    {
+        value += static_cast<char>(0xf0 | (code >> 18));
+        value += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+        value += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        value += static_cast<char>(0x80 | (code & 0x3f));
+    }
+}
+
+bool read_hex(std::string_view& text, std::uint32_t& code) {
+    if (text.size() < 4)
+        return false;
+
+    const auto [end, error] = std::from_chars(text.data(), text.data() + 4, code, 16);
+
+    if (error != std::errc{} || end != text.data() + 4)
+        return false;
+
+    text.remove_prefix(4);
+    return true;
+}
+
+bool read_string(std::string_view& text, std::string& value) {
+    if (text.empty() || text.front() != '"')
+        return false;
+
+    text.remove_prefix(1);
+    value.clear();
+
+    while (!text.empty())
+    {
+        const char c = text.front();
+        text.remove_prefix(1);
+
+        if (c == '"')
+            return true;
+
+        if (c != '\\')
+        {
+            value += c;
+            continue;
+        }
+
+        if (text.empty())
+            return false;
+
+        const char escape = text.front();
+        text.remove_prefix(1);
+
+        if (escape == 'n')
+            value += '\n';
+        else if (escape == 't')
+            value += '\t';
+        else if (escape == 'r')
+            value += '\r';
+        else if (escape == 'b')
+            value += '\b';
+        else if (escape == 'f')
+            value += '\f';
+        else if (escape == '"' || escape == '\\' || escape == '/')
+            value += escape;
+        else if (escape == 'u')
+        {
+            std::uint32_t code, low;
+
+            if (!read_hex(text, code))
+                return false;
+
+            // A surrogate pair spells one code point outside the basic plane
+            if (code >= 0xd800 && code < 0xdc00 && text.starts_with("\\u"))
+            {
+                text.remove_prefix(2);
+
+                if (!read_hex(text, low) || low < 0xdc00 || low >= 0xe000)
+                    return false;
+
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            }
+
+            append_utf8(value, code);
+        }
+        else
+            return false;
+    }
+
+    return false;
+}
+
+// Reads one flat JSON object; fields other than the request's are skipped, as long as they
+// are strings, numbers, booleans or null
+bool parse_request(std::string_view text, Request& request, std::string& error) {
+    const auto fail = [&](std::string message) {
+        error = std::move(message);
+        return false;
+    };
+
+    skip_space(text);
+
+    if (text.empty() || text.front() != '{')
+        return fail("expected a JSON object");
+
+    text.remove_prefix(1);
+    skip_space(text);
+
+    if (!text.empty() && text.front() == '}')
+        return fail("expected an \"op\"");
+
+    std::string key, value;
+
+    while (true)
+    {
+        skip_space(text);
+
+        if (!read_string(text, key))
+            return fail("expected a field name");
+
+        skip_space(text);
+
+        if (text.empty() || text.front() != ':')
+            return fail("expected ':' after \"" + key + "\"");
+
+        text.remove_prefix(1);
+        skip_space(text);
+
+        if (!text.empty() && text.front() == '"')
+        {
+            if (!read_string(text, value))
+                return fail("unterminated string in \"" + key + "\"");
+
+            if (key == "op")
+                request.op = value;
+            else if (key == "id")
+                request.id = value;
+            else if (key == "roster")
+                request.roster = value;
+            else if (key == "seconds" || key == "restarts" || key == "target")
+                return fail("\"" + key + "\" must be a number");
+        }
+        else if (text.starts_with("true") || text.starts_with("null"))
+            text.remove_prefix(4);
+        else if (text.starts_with("false"))
+            text.remove_prefix(5);
+        else
+        {
+            double     number;
+            const auto [end, failure] =
+              std::from_chars(text.data(), text.data() + text.size(), number);
+
+            if (failure != std::errc{})
+                return fail("bad value for \"" + key + "\"");
+
+            text.remove_prefix(end - text.data());
+
+            if (key == "seconds")
+            {
+                if (number <= 0)
+                    return fail("\"seconds\" must be positive");
+
+                request.limits.seconds = number;
+            }
+            else if (key == "restarts")
+            {
+                if (number < 1 || number != static_cast<double>(static_cast<std::size_t>(number)))
+                    return fail("\"restarts\" must be a positive integer");
+
+                request.limits.restarts = static_cast<std::size_t>(number);
+            }
+            else if (key == "target")
+                request.limits.target = number;
+            else if (key == "op" || key == "id" || key == "roster")
+                return fail("\"" + key + "\" must be a string");
+        }
+
+        skip_space(text);
+
+        if (text.empty())
+            return fail("unterminated object");
+
+        const char separator = text.front();
+        text.remove_prefix(1);
+
+        if (separator == '}')
+            break;
+
+        if (separator != ',')
+            return fail("expected ',' or '}'");
+    }
+
+    skip_space(text);
+
+    if (!text.empty())
+        return fail("unexpected text after the object");
+
+    if (request.op.empty())
+        return fail("expected an \"op\"");
+
+    return true;
+}
+
+class Service {
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t RestartSlice = 16;
+
+    struct Entry {
+        std::string                 id;
+        std::shared_ptr<ServiceJob> job;
+
+        // Guarded by the service's mutex; set once the done event is due
+        bool done = false;
+    };
+
+    std::ostream& out;
+    std::mutex    output_mutex;
+
+    const std::size_t max_jobs;
+
+    std::mutex                                              mutex;
+    std::condition_variable                                 ready;
+    // Jobs that are queued or running; a job leaves with its done event
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+    std::deque<std::shared_ptr<Entry>>                      queued;
+    std::vector<std::shared_ptr<Entry>>                     active;
+    std::size_t                                             cursor   = 0;
+    bool                                                    stopping = false;
+
+    std::vector<std::thread> workers;
+
+    void work();
+
+    // Forgets a finished job and starts queued ones in its place. Returns whether the caller
+    // is the one to report it.
+    [[nodiscard]] bool retire(const std::shared_ptr<Entry>&);
+
+    void emit(const std::string&);
+    void report(const char* event, const Entry&);
+
+   public:
+    Service(std::ostream&, std::size_t threads, std::size_t max_jobs);
+    ~Service();
+
+    void error(std::string_view id, std::string_view message);
+
+    void submit(const Request&, const JobFactory&);
+    void cancel(const std::string&);
+    void best(const std::string&);
+};
+
+Service::Service(std::ostream& output, std::size_t threads, std::size_t job_limit) :
+    out{output},
+    max_jobs{job_limit} {
+    workers.reserve(threads);
+
+    for (std::size_t i = 0; i < threads; i++)
+        workers.emplace_back(&Service::work, this);
+}
+
+Service::~Service() {
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+
+        for (const auto& [id, entry] : entries)
+            entry->job->cancel();
+    }
+
+    ready.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    for (const auto& [id, entry] : entries)
+        report("done", *entry);
+}
+
+// A worker stays on one job for a slice of restarts before taking the next in turn. The
+// per-thread distance table, scratch charts and tabu list are built for one room shape, and
+// a worker passed a different room every restart would rebuild them every time.
+void Service::work() {
+    std::shared_ptr<Entry> entry;
+    std::size_t            slice = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock lock{mutex};
+            ready.wait(lock, [&] { return stopping || !active.empty(); });
+
+            if (stopping)
+                return;
+
+            if (!entry || entry->done || slice == RestartSlice)
+            {
+                entry = active[cursor++ % active.size()];
+                slice = 0;
+            }
+        }
+
+        slice++;
+
+        if (entry->job->restart())
+            continue;
+
+        if (retire(entry))
+            report("done", *entry);
+
+        entry.reset();
+    }
+}
+
+bool Service::retire(const std::shared_ptr<Entry>& entry) {
+    std::lock_guard lock{mutex};
+
+    if (entry->done)
+        return false;
+
+    entry->done = true;
+    entries.erase(entry->id);
+    std::erase(active, entry);
+    std::erase(queued, entry);
+
+    while (active.size() < max_jobs && !queued.empty())
+    {
+        active.push_back(std::move(queued.front()));
+        queued.pop_front();
+    }
+
+    ready.notify_all();
+    return true;
+}
+
+void Service::emit(const std::string& line) {
+    std::lock_guard lock{output_mutex};
+    out << line << '\n' << std::flush;
+}
+
+void Service::report(const char* event, const Entry& entry) {
+    std::ostringstream line;
+
+    line << "{\"event\":\"" << event << "\",\"id\":";
+    write_json_string(line, entry.id);
+    line << ",";
+    entry.job->describe(line);
+    line << "}";
+
+    emit(line.str());
+}
+
+void Service::error(std::string_view id, std::string_view message) {
+    std::ostringstream line;
+
+    line << "{\"event\":\"error\"";
+
+    if (!id.empty())
+    {
+        line << ",\"id\":";
+        write_json_string(line, id);
+    }
+
+    line << ",\"message\":";
+    write_json_string(line, message);
+    line << "}";
+
+    emit(line.str());
+}
+
+void Service::submit(const Request& request, const JobFactory& factory) {
+    if (request.id.empty())
+        return error({}, "submit needs an \"id\"");
+
+    if (request.roster.empty())
+        return error(request.id, "submit needs a \"roster\"");
+
+    {
+        std::lock_guard lock{mutex};
+
+        if (entries.contains(request.id))
+            return error(request.id, "a job with this id has not finished");
+    }
+
+    // Improvements can only come once the job is on the active list, after the accepted event
+    const auto submitted = Clock::now();
+    const auto sink      = [this, id = request.id, submitted](double score, std::size_t restart) {
+        std::ostringstream line;
+
+        line << "{\"event\":\"improved\",\"id\":";
+        write_json_string(line, id);
+        line << ",\"score\":" << score << ",\"restart\":" << restart << ",\"seconds\":"
+             << std::chrono::duration<double>(Clock::now() - submitted).count() << "}";
+
+        emit(line.str());
+    };
+
+    std::string message;
+    auto        job = factory(request.roster, request.limits, sink, message);
+
+    if (!job)
+        return error(request.id, message);
+
+    auto entry = std::make_shared<Entry>(Entry{request.id, std::move(job)});
+    bool waits;
+
+    {
+        std::lock_guard lock{mutex};
+
+        entries[request.id] = entry;
+        waits               = active.size() >= max_jobs;
+
+        if (waits)
+            queued.push_back(entry);
+    }
+
+    std::string_view header = request.roster;
+    std::size_t      rows = 0, columns = 0;
+    static_cast<void>(parse_room_size(header, rows, columns));
+
+    std::ostringstream line;
+
+    line << "{\"event\":\"accepted\",\"id\":";
+    write_json_string(line, request.id);
+    line << ",\"rows\":" << rows << ",\"columns\":" << columns
+         << ",\"queued\":" << (waits ? "true" : "false") << "}";
+
+    emit(line.str());
+
+    if (waits)
+        return;
+
+    {
+        std::lock_guard lock{mutex};
+        active.push_back(entry);
+    }
+
+    ready.notify_all();
+}
+
+void Service::cancel(const std::string& id) {
+    std::shared_ptr<Entry> entry;
+
+    {
+        std::lock_guard lock{mutex};
+
+        if (const auto found = entries.find(id); found != entries.end())
+            entry = found->second;
+    }
+
+    if (!entry)
+        return error(id, "no such job");
+
+    entry->job->cancel();
+
+    // A queued job never runs a restart to notice, and a running one may be between restarts
+    // on every thread, so retire it here; a worker that sees it end first reports it instead
+    if (retire(entry))
+        report("done", *entry);
+}
+
+void Service::best(const std::string& id) {
+    std::shared_ptr<Entry> entry;
+
+    {
+        std::lock_guard lock{mutex};
+
+        if (const auto found = entries.find(id); found != entries.end())
+            entry = found->second;
+    }
+
+    if (!entry)
+        return error(id, "no such job");
+
+    report("best", *entry);
+}
+
+}
+
+void write_json_string(std::ostream& out, std::string_view text) {
+    constexpr char Hex[] = "0123456789abcdef";
+
+    out << '"';
+
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (c == '\n')
+            out << "\\n";
+        else if (c == '\t')
+            out << "\\t";
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << "\\u00" << Hex[c >> 4] << Hex[c & 0xf];
+        else
+            out << c;
+    }
+
+    out << '"';
+}
+
+int run_service(std::istream& in,
+                std::ostream& out,
+                std::size_t   threads,
+                std::size_t   max_jobs,
+                JobFactory    factory) {
+    Service     service{out, threads, max_jobs};
+    std::string line;
+
+    while (std::getline(in, line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        Request     request;
+        std::string message;
+
+        if (!parse_request(line, request, message))
+            service.error(request.id, message);
+        else if (request.op == "submit")
+            service.submit(request, factory);
+        else if (request.op == "cancel")
+            service.cancel(request.id);
+        else if (request.op == "best")
+            service.best(request.id);
+        else if (request.op == "shutdown")
+            break;
+        else
+            service.error(request.id, "unknown op '" + request.op
+                                        + "', expected submit, cancel, best or shutdown");
+    }
+
+    return 0;
+}
+
+}
@@ -0,0 +1,246 @@
+#ifndef SERVICE_HPP_INCLUDED
+#define SERVICE_HPP_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "parallelsearch.hpp"
+#include "parse.hpp"
+#include "seatingchart.hpp"
+#include "simulation.hpp"
+
+namespace SeatingChartGenetic {
+
+// Optimizer service: a long-running process that takes classes as JSON lines on one stream
+// and answers with JSON lines on another, keeping its worker threads and the classes it is
+// searching in memory. A job is forgotten once its done event, which carries its final chart,
+// has been sent. Requests, one object per line:
+//   {"op":"submit","id":ID,"roster":TEXT[,"seconds":T][,"restarts":N][,"target":S]}
+//       TEXT is an input file's contents; the job ends at the first of its deadline, T
+//       seconds after it was submitted, its restart budget or its target
+//   {"op":"cancel","id":ID}
+//   {"op":"best","id":ID}       the best chart so far of a queued or running job
+//   {"op":"shutdown"}           as is the end of the input: cancels every job and returns
+// Events:
+//   {"event":"accepted","id":ID,"rows":R,"columns":C,"queued":BOOL}
+//   {"event":"improved","id":ID,"score":S,"restart":K,"seconds":T}
+//   {"event":"best","id":ID,"status":...,"score":S,"restarts":N,"seconds":T,"chart":[[NAME..]..]}
+//   {"event":"done","id":ID,"status":...,"score":S,"restarts":N,"seconds":T,"chart":...}
+//   {"event":"error"[,"id":ID],"message":TEXT}
+// status is "running", "budget", "deadline", "target" or "cancelled".
+struct JobLimits {
+    double                seconds  = 0;
+    std::size_t           restarts = 0;
+    std::optional<double> target;
+};
+
+enum class JobEnd {
+    Running,
+    Budget,
+    Deadline,
+    Target,
+    Cancelled
+};
+
+// Called for every new best chart of a job, with its score and restart number
+using ImprovementSink = std::function<void(double, std::size_t)>;
+
+// A class the service searches, with its room size and scoring policy erased like a BatchJob's.
+// Any number of threads may call restart() at once.
+struct ServiceJob {
+    // Runs one restart, returning false once the job has ended
+    std::function<bool()> restart;
+
+    // Ends the job at once; restarts already running finish, but cannot improve it
+    std::function<void()>   cancel;
+    std::function<JobEnd()> end;
+
+    // Appends the status, score, restarts, seconds and chart fields of an event
+    std::function<void(std::ostream&)> describe;
+};
+
+// Builds the job for a roster, or returns nothing and says why
+using JobFactory = std::function<std::shared_ptr<ServiceJob>(
+  std::string_view roster, const JobLimits&, ImprovementSink, std::string& error)>;
+
+// Serves requests from `in` until it ends or a shutdown, running the restarts of at most
+// `max_jobs` jobs at once on `threads` threads; later jobs wait in submission order.
+int run_service(std::istream& in,
+                std::ostream& out,
+                std::size_t   threads,
+                std::size_t   max_jobs,
+                JobFactory);
+
+void write_json_string(std::ostream&, std::string_view);
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+[[nodiscard]] std::shared_ptr<ServiceJob> make_service_job(ParseResult<Row, Column>&&,
+                                                           const JobLimits&,
+                                                           SearchConfig,
+                                                           const Policy&,
+                                                           ImprovementSink);
+
+}
+
+namespace SeatingChartGenetic {
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+std::shared_ptr<ServiceJob> make_service_job(ParseResult<Row, Column>&& parsed,
+                                             const JobLimits&           limits,
+                                             SearchConfig               config,
+                                             const Policy&              policy,
+                                             ImprovementSink            on_improved) {
+    using Clock = std::chrono::steady_clock;
+
+    config.restarts = limits.restarts;
+
+    struct State {
+        ParseResult<Row, Column>         parsed;
+        JobLimits                        limits;
+        SearchConfig                     config;
+        SearchLanes<Row, Column, Policy> lanes;
+        ImprovementSink                  on_improved;
+        Clock::time_point                start = Clock::now();
+
+        std::atomic<std::size_t> completed{0};
+
+        // The best chart and how the job ended change together, so no improvement is
+        // reported after the job has ended
+        mutable std::mutex        mutex;
+        SeatingChart<Row, Column> best_chart;
+        std::atomic<double>       best_score;
+        std::atomic<JobEnd>       end{JobEnd::Running};
+        double                    ended_after = 0;
+
+        // Raised with the end, to cut short the restarts in flight
+        std::atomic<bool> stopping{false};
+        StopToken         stop_token{stopping, deadline_after(limits.seconds, start)};
+
+        State(ParseResult<Row, Column>&& result,
+              const JobLimits&           job_limits,
+              const SearchConfig&        search_config,
+              const Policy&              policy,
+              ImprovementSink&&          sink) :
+            parsed{std::move(result)},
+            limits{job_limits},
+            config{search_config},
+            lanes{parsed.chart, parsed.class_info, config, policy},
+            on_improved{std::move(sink)},
+            best_chart{parsed.chart},
+            best_score{score_chart(parsed.chart, parsed.class_info, policy)} {}
+
+        [[nodiscard]] double seconds() const {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        void finish(JobEnd reason) {
+            std::lock_guard lock{mutex};
+
+            stop(reason);
+        }
+
+        // With the mutex held
+        void stop(JobEnd reason) {
+            if (end.load() != JobEnd::Running)
+                return;
+
+            end.store(reason);
+            ended_after = seconds();
+            stopping.store(true);
+        }
+    };
+
+    auto state = std::make_shared<State>(std::move(parsed), limits, config, policy,
+                                         std::move(on_improved));
+    auto job   = std::make_shared<ServiceJob>();
+
+    job->restart = [state] {
+        auto& s = *state;
+
+        if (s.limits.seconds > 0 && s.seconds() >= s.limits.seconds)
+            s.finish(JobEnd::Deadline);
+
+        if (s.end.load() != JobEnd::Running)
+            return false;
+
+        const bool ran = s.lanes.with_lane([&](SearchLane<Row, Column, Policy>& lane) {
+            const double score = lane.template restart<DefaultShuffleSwaps>(s.config, s.stop_token);
+
+            // A restart that outlives the job does not count towards it
+            if (s.end.load() != JobEnd::Running)
+                return;
+
+            s.completed.fetch_add(1, std::memory_order_relaxed);
+
+            if (score <= s.best_score.load(std::memory_order_relaxed))
+                return;
+
+            std::lock_guard lock{s.mutex};
+
+            if (s.end.load() != JobEnd::Running
+                || score <= s.best_score.load(std::memory_order_relaxed))
+                return;
+
+            s.best_chart = lane.chart();
+            s.best_score.store(score);
+            s.on_improved(score, lane.last_restart());
+
+            if (s.limits.target && score >= *s.limits.target - ScoreTolerance)
+                s.stop(JobEnd::Target);
+        });
+
+        if (!ran)
+            s.finish(JobEnd::Budget);
+
+        return s.end.load() == JobEnd::Running;
+    };
+
+    job->cancel = [state] { state->finish(JobEnd::Cancelled); };
+
+    job->end = [state] { return state->end.load(); };
+
+    job->describe = [state](std::ostream& out) {
+        auto& s = *state;
+
+        std::lock_guard lock{s.mutex};
+
+        constexpr const char* Statuses[] = {"running", "budget", "deadline", "target", "cancelled"};
+
+        out << "\"status\":\"" << Statuses[static_cast<std::size_t>(s.end.load())] << "\",\"score\":"
+            << s.best_score.load() << ",\"restarts\":" << s.completed.load()
+            << ",\"seconds\":" << (s.end.load() == JobEnd::Running ? s.seconds() : s.ended_after)
+            << ",\"chart\":[";
+
+        for (std::size_t row = 0; row < s.best_chart.rows(); row++)
+        {
+            out << (row == 0 ? "[" : ",[");
+
+            for (std::size_t column = 0; column < s.best_chart.columns(); column++)
+            {
+                if (column > 0)
+                    out << ",";
+
+                write_json_string(out, s.parsed.lookup_name[s.best_chart.seats()[row][column]]);
+            }
+
+            out << "]";
+        }
+
+        out << "]";
+    };
+
+    return job;
+}
+
+}
+
+#endif
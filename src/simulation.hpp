@@ -1,22 +1,214 @@
 #ifndef SIMULATION_HPP_INCLUDED
 #define SIMULATION_HPP_INCLUDED
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <cmath>
 #include <cstddef>
-#include <functional>
+#include <cstdint>
+#include <numeric>
 #include <random>
+#include <span>
 #include <vector>
 
+#include "batchscore.hpp"
 #include "classinfo.hpp"
+#include "random.hpp"
+#include "scoring.hpp"
 #include "seatingchart.hpp"
+#include "stats.hpp"
+#include "workerpool.hpp"
 
 namespace SeatingChartGenetic {
 
 namespace {
 
-constexpr int distance_squared(const Location location1, const Location location2) {
-    return (location1.row - location2.row) * (location1.row - location2.row)
-         + (location1.column - location2.column) * (location1.column - location2.column);
+constexpr std::size_t seat_index(const Location location, const std::size_t columns) noexcept {
+    return location.row * columns + location.column;
+}
+
+constexpr std::size_t apart(const std::size_t first, const std::size_t second) noexcept {
+    return first < second ? second - first : first - second;
+}
+
+// Fills `table` with the closeness of every two seats of a rows x columns grid under a
+// distance kernel, indexed by flattened seat numbers. A seat's weight towards itself is 0 so
+// dense kernels can run over whole rows.
+constexpr void fill_inverse_distances(double* const      table,
+                                      const std::size_t  rows,
+                                      const std::size_t  columns,
+                                      const DistanceKind kind) noexcept {
+    const auto seats = rows * columns;
+
+    for (std::size_t first = 0; first < seats; first++)
+        for (std::size_t second = 0; second < seats; second++)
+            table[first * seats + second] =
+              first == second ? 0.0
+                              : closeness(kind, apart(first / columns, second / columns),
+                                          apart(first % columns, second % columns));
+}
+
+template<typename Distance, std::size_t Row, std::size_t Column>
+alignas(64) inline constexpr auto inverse_distance_table = [] {
+    std::array<double, Row * Column * Row * Column> table{};
+    fill_inverse_distances(table.data(), Row, Column, Distance::kind);
+    return table;
+}();
+
+// Runtime-sized charts get their table built on first use; a thread almost always works on a
+// single room shape and kernel, so one cached table per thread is enough.
+inline const double* dynamic_inverse_distances(const std::size_t  rows,
+                                               const std::size_t  columns,
+                                               const DistanceKind kind) {
+    thread_local std::vector<double> table;
+    thread_local std::size_t         cached_rows    = 0;
+    thread_local std::size_t         cached_columns = 0;
+    thread_local DistanceKind        cached_kind    = DistanceKind::Euclidean;
+
+    if (rows != cached_rows || columns != cached_columns || kind != cached_kind)
+    {
+        table.assign(rows * columns * rows * columns, 0.0);
+        fill_inverse_distances(table.data(), rows, columns, kind);
+        cached_rows    = rows;
+        cached_columns = columns;
+        cached_kind    = kind;
+    }
+
+    return table.data();
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+const double* inverse_distances_of(const SeatingChart<Row, Column>& chart, const Policy& policy) {
+    if constexpr (Row == Dynamic)
+        return dynamic_inverse_distances(chart.rows(), chart.columns(), policy.distance());
+    else if constexpr (is_static_scoring<Policy>)
+        return inverse_distance_table<typename Policy::distance_type, Row, Column>.data();
+    else
+    {
+        if (policy.distance() == DistanceKind::Manhattan)
+            return inverse_distance_table<ManhattanDistance, Row, Column>.data();
+
+        if (policy.distance() == DistanceKind::Rows)
+            return inverse_distance_table<RowDistance, Row, Column>.data();
+
+        return inverse_distance_table<EuclideanDistance, Row, Column>.data();
+    }
+}
+
+// Tablemate weights of a student, were they sitting at `location`, towards everyone else at
+// that table
+template<std::size_t Row, std::size_t Column, typename Policy>
+constexpr double table_terms(const SeatingChart<Row, Column>& chart,
+                             const ClassInfo<Row * Column>&   class_info,
+                             const Policy&                    policy,
+                             const std::size_t                student,
+                             const Location                   location) noexcept {
+    const auto& row = chart.seats()[location.row];
+
+    // The layout the rooms are built for: one tablemate, found without a loop
+    if constexpr (static_table_seats<Policy> == 2)
+        return class_info.tablemate_weight(
+          student, row[SeatingChart<Row, Column>::tablemate_column(location.column, 2)]);
+
+    double total = 0;
+
+    for (auto mate = table_begin(policy, location.column);
+         mate < table_end(policy, location.column, chart.columns()); mate++)
+        if (mate != location.column)
+            total += class_info.tablemate_weight(student, row[mate]);
+
+    return total;
+}
+
+template<typename Policy>
+constexpr bool same_table(const Policy& policy, const Location first, const Location second) {
+    return first.row == second.row
+        && table_begin(policy, first.column) == table_begin(policy, second.column);
+}
+
+// Change in the distance terms when moved[2k] and moved[2k + 1] trade seats for every k.
+// Relationships towards students that stay put are summed per exchanged pair, densely for
+// fixed-size rooms, whose loops vectorise, and over the neighbour lists otherwise;
+// relationships among the moved students are corrected afterwards.
+template<std::size_t Row, std::size_t Column, typename Policy, std::size_t Moved>
+constexpr double distance_delta(const SeatingChart<Row, Column>&      chart,
+                                const ClassInfo<Row * Column>&        class_info,
+                                const Policy&                         policy,
+                                const std::array<std::size_t, Moved>& moved) noexcept {
+    const auto  num_students      = chart.size();
+    const auto* inverse_distances = inverse_distances_of(chart, policy);
+
+    const auto seat_of = [&](const std::size_t student) {
+        return seat_index(chart.locations()[student], chart.columns());
+    };
+    const auto distances_from = [&](const std::size_t student) {
+        return inverse_distances + seat_of(student) * num_students;
+    };
+    const auto exchange_term = [&](const std::size_t index, const std::size_t other) {
+        const auto seat = seat_of(other);
+
+        return (class_info.distance_weight(moved[index], other)
+                - class_info.distance_weight(moved[index + 1], other))
+             * (distances_from(moved[index + 1])[seat] - distances_from(moved[index])[seat]);
+    };
+
+    // Weighted change of 1/d^2 towards every neighbour of a student between two seats' rows
+    const auto neighbour_change = [&](const std::size_t   student,
+                                      const double* const distances_old,
+                                      const double* const distances_new) {
+        const auto neighbours = class_info.neighbours_of(student);
+        const auto weights    = class_info.neighbour_weights_of(student);
+
+        double change = 0;
+
+        for (std::size_t i = 0; i < neighbours.size(); i++)
+        {
+            const auto seat = seat_of(neighbours[i]);
+            change += weights[i] * (distances_new[seat] - distances_old[seat]);
+        }
+
+        return change;
+    };
+
+    double total_delta = 0;
+
+    // The first student of each pair gains the second's seat, and the second the first's
+    for (std::size_t index = 0; index < Moved; index += 2)
+    {
+        const auto* distances_old = distances_from(moved[index]);
+        const auto* distances_new = distances_from(moved[index + 1]);
+
+        if constexpr (Row != Dynamic)
+        {
+            const auto weights_from = class_info.distance_weights_of(moved[index]);
+            const auto weights_to   = class_info.distance_weights_of(moved[index + 1]);
+
+            for (std::size_t other = 0; other < num_students; other++)
+            {
+                const auto seat = seat_of(other);
+                total_delta += (weights_from[other] - weights_to[other])
+                             * (distances_new[seat] - distances_old[seat]);
+            }
+        }
+        else
+            total_delta += neighbour_change(moved[index], distances_old, distances_new)
+                         - neighbour_change(moved[index + 1], distances_old, distances_new);
+    }
+
+    // The first pass assumed every other student stayed put, which is false for moved ones
+    for (std::size_t i = 0; i < Moved; i++)
+    {
+        for (std::size_t index = 0; index < Moved; index += 2)
+            total_delta -= exchange_term(index, moved[i]);
+
+        for (std::size_t j = i + 1; j < Moved; j++)
+            total_delta += class_info.distance_weight(moved[i], moved[j])
+                         * (distances_from(moved[i ^ 1])[seat_of(moved[j ^ 1])]
+                            - distances_from(moved[i])[seat_of(moved[j])]);
+    }
+
+    return total_delta;
 }
 
 }
@@ -35,21 +227,158 @@ struct ScoredChart {
 template<std::size_t Row, std::size_t Column>
 auto operator<=>(const ScoredChart<Row, Column>&, const ScoredChart<Row, Column>&);
 
-template<std::size_t Row, std::size_t Column>
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+class ChartScorer;
+
+// Scores whole charts BatchLanes at a time: their seats are transposed into one
+// structure-of-arrays block, and the distance terms, which dominate score_chart, are summed
+// by the SIMD kernel of batchscore.cpp. The block is kept between calls, so scoring does not
+// allocate.
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+class BatchScorer {
+    const ClassInfo<Row * Column>& class_info;
+    [[no_unique_address]] Policy   policy;
+    std::vector<std::uint32_t>     upper_begin;
+    std::vector<std::uint32_t>     seats;
+
+   public:
+    explicit BatchScorer(const ClassInfo<Row * Column>&, Policy = {});
+
+    // Scores `charts` charts, the i-th being chart_at(i), and hands each to store(i, score).
+    template<typename ChartAt, typename Store>
+    void score(std::size_t charts, ChartAt&&, Store&&);
+
+    void score(std::span<const SeatingChart<Row, Column>>, std::span<double>);
+};
+
+// Generational GA: elitism, tournament selection, order crossover and swap mutations.
+// Scoring and breeding of a generation are split across `threads` threads, started with the
+// simulation and kept for its lifetime. Each child is bred from its own PRNG stream, keyed by
+// the seed, its generation and its place, so no state is shared while breeding and a seed
+// breeds the same generations on any thread count; only immigrants make a run depend on
+// timing. Generations alternate between two preallocated populations, elites are picked by
+// ranking indices and children are bred in place, so on any thread count stepping copies only
+// the elites and allocates nothing.
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
 class Simulation {
-    std::vector<ScoredChart<Row, Column>> population;
-    ClassInfo<Row * Column>               class_info;
-    std::default_random_engine            rng;
+    static constexpr std::size_t TournamentSize      = 3;
+    static constexpr std::size_t EliteDivisor        = 10;
+    static constexpr std::size_t PairMutationPercent = 30;
+
+    std::vector<ScoredChart<Row, Column>>   population;
+    std::vector<ScoredChart<Row, Column>>   offspring;
+    ClassInfo<Row * Column>                       class_info;
+    ChartScorer<Row, Column, Policy>              rules;
+    std::uint64_t                                 seed;
+    std::size_t                                   generation = 0;
+    std::vector<BatchScorer<Row, Column, Policy>> scorers;
+    std::vector<std::size_t>                      ranking;
+
+    // Last, so its threads stop before anything they use is destroyed
+    WorkerPool workers;
+
+    template<typename PRNG>
+    const ScoredChart<Row, Column>& tournament(PRNG&) const noexcept;
 
    public:
-    Simulation(const SeatingChart<Row, Column>&, const ClassInfo<Row * Column>&, std::size_t);
+    Simulation(const SeatingChart<Row, Column>&,
+               const ClassInfo<Row * Column>&,
+               std::size_t,
+               std::size_t   = 1,
+               std::uint64_t = 42,
+               Policy        = {});
+
+    // The scorers refer to this simulation's ClassInfo
+    Simulation(const Simulation&)            = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
     SimulationInfo                  step() noexcept;
     const ScoredChart<Row, Column>& top() const noexcept;
+
+    // Puts a chart from elsewhere, such as another island, into the next generation in place
+    // of its last child
+    void immigrate(const SeatingChart<Row, Column>&);
 };
 
-template<std::size_t Row, std::size_t Column>
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
 [[nodiscard]] constexpr double score_chart(const SeatingChart<Row, Column>&,
-                                           const ClassInfo<Row * Column>&) noexcept;
+                                           const ClassInfo<Row * Column>&,
+                                           const Policy& = {}) noexcept;
+
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+[[nodiscard]] constexpr double score_swap_students(const SeatingChart<Row, Column>&,
+                                                   const ClassInfo<Row * Column>&,
+                                                   std::size_t,
+                                                   std::size_t,
+                                                   const Policy& = {}) noexcept;
+
+template<std::size_t Row, std::size_t Column, typename Policy = DefaultScoring>
+[[nodiscard]] constexpr double score_swap_pairs(const SeatingChart<Row, Column>&,
+                                                const ClassInfo<Row * Column>&,
+                                                std::size_t,
+                                                std::size_t,
+                                                const Policy& = {}) noexcept;
+
+// Scorer handed to the SeatingChart climbers: full scoring plus O(deg) swap deltas, and the
+// class's constraints, which the climbers check before scoring a move. The scoring policy
+// lays out the tables for both.
+template<std::size_t Row, std::size_t Column, typename Policy>
+class ChartScorer {
+    const ClassInfo<Row * Column>& class_info;
+    [[no_unique_address]] Policy   policy;
+
+   public:
+    explicit constexpr ChartScorer(const ClassInfo<Row * Column>& cinfo, Policy p = {}) :
+        class_info{cinfo},
+        policy{p} {}
+
+    [[nodiscard]] constexpr double
+    operator()(const SeatingChart<Row, Column>& chart) const noexcept {
+        count(StatCounter::ScoreCalls);
+        return score_chart(chart, class_info, policy);
+    }
+
+    [[nodiscard]] constexpr const Policy& scoring() const noexcept { return policy; }
+
+    [[nodiscard]] constexpr bool has_relationships(std::size_t student) const noexcept {
+        return class_info.has_relationships(student);
+    }
+
+    [[nodiscard]] constexpr bool constrained() const noexcept { return class_info.constrained(); }
+
+    [[nodiscard]] constexpr bool allows(const SeatingChart<Row, Column>& chart) const noexcept {
+        return class_info.allows(chart, policy);
+    }
+
+    [[nodiscard]] constexpr bool allows_swap_students(const SeatingChart<Row, Column>& chart,
+                                                      std::size_t                      first,
+                                                      std::size_t second) const noexcept {
+        return class_info.allows_swap_students(chart, first, second, policy);
+    }
+
+    // A pair swap trades two students and their tablemates for each other, which moves whole
+    // tables when they seat two. It needs a tablemate other than the student, and two tables:
+    // within one it would only shuffle that table's students.
+    [[nodiscard]] constexpr bool allows_swap_pairs(const SeatingChart<Row, Column>& chart,
+                                                   std::size_t                      first,
+                                                   std::size_t second) const noexcept {
+        return policy.table_seats() >= 2
+            && !same_table(policy, chart.locations()[first], chart.locations()[second])
+            && class_info.allows_swap_pairs(chart, first, second, policy);
+    }
+
+    [[nodiscard]] constexpr double swap_students_delta(const SeatingChart<Row, Column>& chart,
+                                                       std::size_t                      first,
+                                                       std::size_t second) const noexcept {
+        return score_swap_students(chart, class_info, first, second, policy);
+    }
+
+    [[nodiscard]] constexpr double swap_pairs_delta(const SeatingChart<Row, Column>& chart,
+                                                    std::size_t                      first,
+                                                    std::size_t second) const noexcept {
+        return score_swap_pairs(chart, class_info, first, second, policy);
+    }
+};
 
 }
 
@@ -65,93 +394,313 @@ auto operator<=>(const ScoredChart<Row, Column>& chart, const ScoredChart<Row, C
     return chart.score <=> other.score;
 }
 
-template<std::size_t Row, std::size_t Column>
-Simulation<Row, Column>::Simulation(const SeatingChart<Row, Column>& seed,
-                                    const ClassInfo<Row * Column>&   cinfo,
-                                    std::size_t                      cnt) :
+template<std::size_t Row, std::size_t Column, typename Policy>
+Simulation<Row, Column, Policy>::Simulation(const SeatingChart<Row, Column>& chart,
+                                            const ClassInfo<Row * Column>&   cinfo,
+                                            std::size_t                      cnt,
+                                            std::size_t                      threads,
+                                            std::uint64_t                    prng_seed,
+                                            Policy                           policy) :
     class_info{cinfo},
-    rng{42} {
+    rules{class_info, policy},
+    seed{prng_seed},
+    workers{threads} {
+    assert(cnt > 0 && threads > 0);
+
+    scorers.reserve(threads);
+
+    for (std::size_t i = 0; i < threads; i++)
+        scorers.emplace_back(class_info, policy);
+
     population.reserve(cnt);
 
+    // The first population takes streams 0 .. cnt - 1, and generation g's children the next cnt
+    // after those of generation g - 1
     for (std::size_t i = 0; i < cnt; i++)
     {
-        population.emplace_back(seed, 0);
-        population.back().chart.random_shuffle(rng);
+        Xoshiro256 rng{seed, i};
+
+        population.emplace_back(chart, 0);
+        population.back().chart.random_shuffle(rng, rules);
     }
+
+    offspring = population;
+    ranking.resize(cnt);
 }
 
-template<std::size_t Row, std::size_t Column>
-SimulationInfo Simulation<Row, Column>::step() noexcept {
-    using std::begin, std::end, std::cbegin, std::size;
-    using distribution_type = std::uniform_int_distribution<typename decltype(rng)::result_type>;
+template<std::size_t Row, std::size_t Column, typename Policy>
+template<typename PRNG>
+const ScoredChart<Row, Column>&
+Simulation<Row, Column, Policy>::tournament(PRNG& prng) const noexcept {
+    using distribution_type = std::uniform_int_distribution<typename PRNG::result_type>;
+
+    distribution_type gen_index{0, std::size(population) - 1};
 
-    distribution_type dist{0, 100};
+    const auto* winner = &population[gen_index(prng)];
+
+    for (std::size_t i = 1; i < TournamentSize; i++)
+    {
+        const auto& contender = population[gen_index(prng)];
+
+        if (contender.score > winner->score)
+            winner = &contender;
+    }
+
+    return *winner;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+SimulationInfo Simulation<Row, Column, Policy>::step() noexcept {
+    using std::begin, std::end, std::size;
+    using distribution_type = std::uniform_int_distribution<Xoshiro256::result_type>;
+
+    const auto better = [&](std::size_t first, std::size_t second) {
+        return population[first].score > population[second].score;
+    };
 
     SimulationInfo ret;
 
-    for (auto& chart : population)
-        chart.score = score_chart(chart.chart, class_info);
+    const auto score = [&](std::size_t thread, std::size_t chunk_begin, std::size_t chunk_end) {
+        scorers[thread].score(
+          chunk_end - chunk_begin,
+          [&](std::size_t i) -> const auto& { return population[chunk_begin + i].chart; },
+          [&](std::size_t i, double chart_score) {
+              population[chunk_begin + i].score = chart_score;
+          });
+    };
 
-    std::sort(begin(population), end(population), std::greater{});
+    workers.for_each_chunk(size(population), score);
 
-    ret.best_score = population[0].score;
+    // Only the elites need to be ordered; the rest compete through tournaments
+    const auto elites = std::max<std::size_t>(1, size(population) / EliteDivisor);
 
-    auto it = cbegin(population);
-    for (std::size_t i = size(population) / 2; i < size(population); i++)
+    std::iota(begin(ranking), end(ranking), std::size_t{0});
+    std::nth_element(begin(ranking), begin(ranking) + (elites - 1), end(ranking), better);
+    std::sort(begin(ranking), begin(ranking) + elites, better);
+
+    ret.best_score = population[ranking[0]].score;
+
+    for (std::size_t i = 0; i < elites; i++)
     {
-        population[i] = *it;
-        ++it;
+        offspring[i].chart = population[ranking[i]].chart;
+        offspring[i].score = population[ranking[i]].score;
     }
 
-    for (std::size_t i = 1; i < size(population); i++)
-        if (population[i].score > 150)
+    generation++;
+
+    const auto breed = [&](std::size_t, std::size_t chunk_begin, std::size_t chunk_end) {
+        distribution_type dist{0, 100};
+
+        for (std::size_t i = elites + chunk_begin; i < elites + chunk_end; i++)
         {
-            if (dist(rng) > 70)
-                population[i].chart.mutate(rng);
+            Xoshiro256 rng{seed, generation * size(population) + i};
+            auto&      child = offspring[i].chart;
+
+            child.crossover_from(tournament(rng).chart, tournament(rng).chart, rng, rules);
+
+            if (dist(rng) < PairMutationPercent)
+                child.mutate2(rng, rules);
             else
-                population[i].chart.mutate2(rng);
+                child.mutate(rng, rules);
         }
-        else
-            population[i].chart.mutate(rng);
+    };
+
+    workers.for_each_chunk(size(population) - elites, breed);
+
+    std::swap(population, offspring);
 
     return ret;
 }
 
-template<std::size_t Row, std::size_t Column>
-const ScoredChart<Row, Column>& Simulation<Row, Column>::top() const noexcept {
+template<std::size_t Row, std::size_t Column, typename Policy>
+const ScoredChart<Row, Column>& Simulation<Row, Column, Policy>::top() const noexcept {
     return population[0];
 }
 
-template<std::size_t Row, std::size_t Column>
+template<std::size_t Row, std::size_t Column, typename Policy>
+void Simulation<Row, Column, Policy>::immigrate(const SeatingChart<Row, Column>& chart) {
+    population.back().chart = chart;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
 constexpr double score_chart(const SeatingChart<Row, Column>& chart,
-                             const ClassInfo<Row * Column>&   class_info) noexcept {
-    double total_score = 0;
+                             const ClassInfo<Row * Column>&   class_info,
+                             const Policy&                    policy) noexcept {
+    const auto  num_students      = chart.size();
+    const auto* inverse_distances = inverse_distances_of(chart, policy);
+    const auto  weights           = class_info.weights();
 
-    for (const auto& row : chart.seats())
+    const auto seat_of = [&](const std::size_t student) {
+        return seat_index(chart.locations()[student], chart.columns());
+    };
+
+    // Tablemate weights are symmetrised, so each table is counted once from either seat
+    double tablemate_score = 0;
+    double distance_score  = 0;
+
+    for (std::size_t student = 0; student < num_students; student++)
     {
-        for (const auto student : row)
-        {
-            if (class_info.friends_towards(student, chart.get_tablemate(student)))
-                total_score += 5;
+        const auto* distances = inverse_distances + seat_of(student) * num_students;
 
-            if (class_info.enemies_towards(student, chart.get_tablemate(student)))
-                total_score -= 5;
+        tablemate_score +=
+          table_terms(chart, class_info, policy, student, chart.locations()[student]);
 
-            for (const auto stu_friend : class_info.friends_of(student))
-            {
-                total_score +=
-                  4.0 / distance_squared(chart.locations()[student], chart.locations()[stu_friend]);
-            }
+        for (const auto stu_friend : class_info.friends_of(student))
+            distance_score += weights.friends * distances[seat_of(stu_friend)];
 
-            for (const auto stu_enemy : class_info.enemies_of(student))
-            {
-                total_score -=
-                  3.0 / distance_squared(chart.locations()[student], chart.locations()[stu_enemy]);
-            }
+        for (const auto stu_enemy : class_info.enemies_of(student))
+            distance_score -= weights.enemies * distances[seat_of(stu_enemy)];
+    }
+
+    return tablemate_score / 2 + distance_score;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+BatchScorer<Row, Column, Policy>::BatchScorer(const ClassInfo<Row * Column>& cinfo, Policy p) :
+    class_info{cinfo},
+    policy{p},
+    upper_begin(cinfo.size()),
+    seats(cinfo.size() * BatchLanes) {
+    const auto& neighbours = class_info.neighbour_lists();
+
+    // Neighbour lists are sorted, so each student's higher-numbered neighbours end the list
+    for (std::size_t student = 0; student < class_info.size(); student++)
+    {
+        const auto list = neighbours.of(student);
+
+        upper_begin[student] =
+          neighbours.offsets[student]
+          + static_cast<std::uint32_t>(std::upper_bound(list.begin(), list.end(), student)
+                                       - list.begin());
+    }
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+template<typename ChartAt, typename Store>
+void BatchScorer<Row, Column, Policy>::score(std::size_t charts, ChartAt&& chart_at, Store&& store) {
+    const auto  num_students = class_info.size();
+    const auto& neighbours   = class_info.neighbour_lists();
+
+    for (std::size_t block = 0; block < charts; block += BatchLanes)
+    {
+        const auto lanes = std::min(BatchLanes, charts - block);
+
+        std::array<double, BatchLanes> tablemate_scores{};
+        std::array<double, BatchLanes> distance_scores;
+
+        // Spare lanes of a short last block repeat its last chart and are not stored
+        for (std::size_t lane = 0; lane < BatchLanes; lane++)
+        {
+            const auto& chart = chart_at(block + std::min(lane, lanes - 1));
+
+            for (std::size_t student = 0; student < num_students; student++)
+                seats[student * BatchLanes + lane] =
+                  static_cast<std::uint32_t>(seat_index(chart.locations()[student], chart.columns()));
+
+            if (lane < lanes)
+                for (std::size_t student = 0; student < num_students; student++)
+                    tablemate_scores[lane] +=
+                      table_terms(chart, class_info, policy, student, chart.locations()[student]);
         }
+
+        batch_distance_scores({inverse_distances_of(chart_at(block), policy), num_students,
+                               upper_begin.data(), neighbours.offsets.data(),
+                               neighbours.targets.data(), class_info.neighbour_list_weights().data(),
+                               seats.data()},
+                              distance_scores.data());
+
+        for (std::size_t lane = 0; lane < lanes; lane++)
+            store(block + lane, tablemate_scores[lane] / 2 + distance_scores[lane]);
+
+        count(StatCounter::ScoreCalls, lanes);
     }
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+void BatchScorer<Row, Column, Policy>::score(std::span<const SeatingChart<Row, Column>> charts,
+                                             std::span<double>                          scores) {
+    assert(scores.size() >= charts.size());
+
+    score(
+      charts.size(), [&](std::size_t i) -> const auto& { return charts[i]; },
+      [&](std::size_t i, double score) { scores[i] = score; });
+}
+
+// Only the tables of the two seats change, unless both are at the same one
+template<std::size_t Row, std::size_t Column, typename Policy>
+constexpr double score_swap_students(const SeatingChart<Row, Column>& chart,
+                                     const ClassInfo<Row * Column>&   class_info,
+                                     std::size_t                      first,
+                                     std::size_t                      second,
+                                     const Policy&                    policy) noexcept {
+    if (first == second)
+        return 0;
+
+    const auto first_location  = chart.locations()[first];
+    const auto second_location = chart.locations()[second];
+
+    double tablemate_delta = 0;
+
+    if (!same_table(policy, first_location, second_location))
+        tablemate_delta = table_terms(chart, class_info, policy, first, second_location)
+                        - table_terms(chart, class_info, policy, second, second_location)
+                        + table_terms(chart, class_info, policy, second, first_location)
+                        - table_terms(chart, class_info, policy, first, first_location);
+
+    return tablemate_delta
+         + distance_delta(chart, class_info, policy, std::array<std::size_t, 2>{first, second});
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+constexpr double score_swap_pairs(const SeatingChart<Row, Column>& chart,
+                                  const ClassInfo<Row * Column>&   class_info,
+                                  std::size_t                      first,
+                                  std::size_t                      second,
+                                  const Policy&                    policy) noexcept {
+    const auto first_location  = chart.locations()[first];
+    const auto second_location = chart.locations()[second];
+
+    // Scorers only allow pair swaps between two tables
+    if (same_table(policy, first_location, second_location))
+        return 0;
+
+    const auto first_tablemate  = chart.get_tablemate(first, policy.table_seats());
+    const auto second_tablemate = chart.get_tablemate(second, policy.table_seats());
+
+    const auto distance_change = distance_delta(
+      chart, class_info, policy,
+      std::array<std::size_t, 4>{first, second, first_tablemate, second_tablemate});
+
+    // Two-seat tables move whole, so only distance terms change
+    if (policy.table_seats() == 2)
+        return distance_change;
+
+    // At larger tables the students left behind trade two tablemates for the other two
+    const auto rest_change = [&](const Location location, const std::size_t leaving,
+                                 const std::size_t leaving_mate, const std::size_t arriving,
+                                 const std::size_t arriving_mate) {
+        const auto& row = chart.seats()[location.row];
+
+        double change = 0;
+
+        for (auto column = table_begin(policy, location.column);
+             column < table_end(policy, location.column, chart.columns()); column++)
+        {
+            const auto stays = row[column];
+
+            if (stays != leaving && stays != leaving_mate)
+                change += class_info.tablemate_weight(arriving, stays)
+                        + class_info.tablemate_weight(arriving_mate, stays)
+                        - class_info.tablemate_weight(leaving, stays)
+                        - class_info.tablemate_weight(leaving_mate, stays);
+        }
+
+        return change;
+    };
 
-    return total_score;
+    return distance_change
+         + rest_change(first_location, first, first_tablemate, second, second_tablemate)
+         + rest_change(second_location, second, second_tablemate, first, first_tablemate);
 }
 
 }
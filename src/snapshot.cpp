@@ -0,0 +1,258 @@
+#include "snapshot.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace SeatingChartGenetic {
+
+namespace {
+
+constexpr std::array<char, 8> SnapshotMagic{'S', 'C', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr std::uint32_t       ByteOrderMark = 0x01020304;
+constexpr std::size_t         Alignment     = 8;
+
+struct SnapshotHeader {
+    std::array<char, 8> magic;
+    std::uint32_t       version;
+    std::uint32_t       byte_order;
+    std::uint64_t       rows;
+    std::uint64_t       columns;
+    std::uint64_t       name_bytes;
+    std::uint64_t       friend_count;
+    std::uint64_t       enemy_count;
+    std::uint64_t       allowed_count;
+    std::uint64_t       apart_count;
+};
+
+static_assert(sizeof(SnapshotHeader) % Alignment == 0);
+
+// Version 1 headers end before the seat rule counts
+constexpr std::size_t HeaderSizeV1 = offsetof(SnapshotHeader, allowed_count);
+
+constexpr std::size_t padded(std::size_t bytes) noexcept {
+    return (bytes + Alignment - 1) / Alignment * Alignment;
+}
+
+// Views the next array of `count` elements, failing if it would run past the end
+template<typename T>
+bool take(std::string_view& bytes, std::size_t count, std::span<const T>& array) {
+    if (count > bytes.size() / sizeof(T) || padded(count * sizeof(T)) > bytes.size())
+        return false;
+
+    array = {reinterpret_cast<const T*>(bytes.data()), count};
+    bytes.remove_prefix(padded(count * sizeof(T)));
+    return true;
+}
+
+template<typename Offset>
+bool valid_offsets(std::span<const Offset> offsets, std::size_t total) {
+    if (offsets.front() != 0 || offsets.back() != total)
+        return false;
+
+    for (std::size_t i = 1; i < offsets.size(); i++)
+        if (offsets[i] < offsets[i - 1])
+            return false;
+
+    return true;
+}
+
+bool valid_targets(std::span<const std::uint32_t> targets, std::size_t students) {
+    for (const auto target : targets)
+        if (target >= students)
+            return false;
+
+    return true;
+}
+
+// Whether no list names a student twice, as make_adjacency guarantees for parsed classes;
+// the scorers would otherwise disagree on how often a relationship counts
+template<typename Offset>
+bool unique_targets(std::span<const Offset>        offsets,
+                    std::span<const std::uint32_t> targets,
+                    std::size_t                    students) {
+    std::vector<std::size_t> listed_in(students, offsets.size());
+
+    for (std::size_t list = 0; list + 1 < offsets.size(); list++)
+    {
+        for (auto i = offsets[list]; i < offsets[list + 1]; i++)
+        {
+            if (listed_in[targets[i]] == list)
+                return false;
+
+            listed_in[targets[i]] = list;
+        }
+    }
+
+    return true;
+}
+
+template<typename T>
+void write_array(std::ofstream& file, std::span<const T> array) {
+    static constexpr std::array<char, Alignment> Padding{};
+
+    const auto bytes = array.size() * sizeof(T);
+
+    file.write(reinterpret_cast<const char*>(array.data()), bytes);
+    file.write(Padding.data(), padded(bytes) - bytes);
+}
+
+}
+
+bool is_snapshot(std::string_view bytes) noexcept {
+    return bytes.size() >= SnapshotMagic.size()
+        && std::memcmp(bytes.data(), SnapshotMagic.data(), SnapshotMagic.size()) == 0;
+}
+
+bool open_snapshot(std::string_view bytes, SnapshotView& snapshot, std::string& error) {
+    SnapshotHeader header{};
+
+    if (!is_snapshot(bytes) || bytes.size() < HeaderSizeV1)
+    {
+        error = "not a snapshot";
+        return false;
+    }
+
+    // The arrays are viewed in place, which needs the alignment mmap gives
+    if (reinterpret_cast<std::uintptr_t>(bytes.data()) % Alignment != 0)
+    {
+        error = "snapshot is not 8-byte aligned in memory";
+        return false;
+    }
+
+    std::memcpy(&header, bytes.data(), HeaderSizeV1);
+
+    if (header.version != 1 && header.version != SnapshotVersion)
+    {
+        error = "snapshot version " + std::to_string(header.version) + " is not supported";
+        return false;
+    }
+
+    const auto header_size = header.version == 1 ? HeaderSizeV1 : sizeof(header);
+
+    if (bytes.size() < header_size)
+    {
+        error = "snapshot is truncated";
+        return false;
+    }
+
+    std::memcpy(&header, bytes.data(), header_size);
+    bytes.remove_prefix(header_size);
+
+    if (header.byte_order != ByteOrderMark)
+    {
+        error = "snapshot was written on a machine of the other byte order";
+        return false;
+    }
+
+    if (header.rows == 0 || header.columns == 0
+        || header.rows > MaxStudents / header.columns)
+    {
+        error = "bad room size";
+        return false;
+    }
+
+    const std::size_t students = header.rows * header.columns;
+
+    snapshot.rows    = header.rows;
+    snapshot.columns = header.columns;
+
+    std::span<const char> names;
+
+    if (!take(bytes, students + 1, snapshot.name_offsets) || !take(bytes, header.name_bytes, names)
+        || !take(bytes, students, snapshot.seats)
+        || !take(bytes, students + 1, snapshot.friend_offsets)
+        || !take(bytes, header.friend_count, snapshot.friend_targets)
+        || !take(bytes, students + 1, snapshot.enemy_offsets)
+        || !take(bytes, header.enemy_count, snapshot.enemy_targets)
+        || !take(bytes, header.allowed_count ? students + 1 : 0, snapshot.allowed_offsets)
+        || !take(bytes, header.allowed_count, snapshot.allowed_seats)
+        || header.apart_count > MaxStudents * MaxStudents
+        || !take(bytes, header.apart_count * 2, snapshot.apart))
+    {
+        error = "snapshot is truncated";
+        return false;
+    }
+
+    snapshot.names = {names.data(), names.size()};
+
+    if (!valid_offsets(snapshot.name_offsets, header.name_bytes)
+        || !valid_offsets(snapshot.friend_offsets, header.friend_count)
+        || !valid_offsets(snapshot.enemy_offsets, header.enemy_count)
+        || !valid_targets(snapshot.friend_targets, students)
+        || !valid_targets(snapshot.enemy_targets, students)
+        || !unique_targets(snapshot.friend_offsets, snapshot.friend_targets, students)
+        || !unique_targets(snapshot.enemy_offsets, snapshot.enemy_targets, students))
+    {
+        error = "snapshot has a corrupt name table or adjacency";
+        return false;
+    }
+
+    if ((header.allowed_count && !valid_offsets(snapshot.allowed_offsets, header.allowed_count))
+        || !valid_targets(snapshot.allowed_seats, students)
+        || !valid_targets(snapshot.apart, students))
+    {
+        error = "snapshot has corrupt seat rules";
+        return false;
+    }
+
+    std::vector<bool> seated(students);
+
+    for (const auto student : snapshot.seats)
+    {
+        if (student >= students || seated[student])
+        {
+            error = "snapshot seats are not a permutation of the students";
+            return false;
+        }
+
+        seated[student] = true;
+    }
+
+    return true;
+}
+
+bool write_snapshot(const std::string& path, const SnapshotView& snapshot) {
+    const SnapshotHeader header{SnapshotMagic,
+                                SnapshotVersion,
+                                ByteOrderMark,
+                                snapshot.rows,
+                                snapshot.columns,
+                                snapshot.names.size(),
+                                snapshot.friend_targets.size(),
+                                snapshot.enemy_targets.size(),
+                                snapshot.allowed_seats.size(),
+                                snapshot.apart.size() / 2};
+
+    const std::string temporary = path + ".tmp";
+
+    {
+        std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_array(file, snapshot.name_offsets);
+        write_array(file, std::span<const char>{snapshot.names});
+        write_array(file, snapshot.seats);
+        write_array(file, snapshot.friend_offsets);
+        write_array(file, snapshot.friend_targets);
+        write_array(file, snapshot.enemy_offsets);
+        write_array(file, snapshot.enemy_targets);
+        write_array(file, snapshot.allowed_offsets);
+        write_array(file, snapshot.allowed_seats);
+        write_array(file, snapshot.apart);
+
+        if (!file.flush())
+            return false;
+    }
+
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+}
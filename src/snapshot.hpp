@@ -0,0 +1,195 @@
+#ifndef SNAPSHOT_HPP_INCLUDED
+#define SNAPSHOT_HPP_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "classinfo.hpp"
+#include "parse.hpp"
+#include "seatingchart.hpp"
+
+namespace SeatingChartGenetic {
+
+// Version 2 added seat rules; version 1 snapshots still load, as classes without them
+inline constexpr std::uint32_t SnapshotVersion = 2;
+
+// A class and a chart in the binary snapshot format, as arrays viewed in place. The names are
+// one blob indexed by name_offsets; seats lists students row-major; friends and enemies are
+// CSR adjacency, student i's list being targets[offsets[i] .. offsets[i + 1]). Seat rules are
+// CSR lists of allowed seats in the same form, left empty when no student has one, and the
+// pairs kept apart flattened two students at a time.
+//
+// On disk a fixed header (magic, version, byte order, rows, columns and array lengths) is
+// followed by the arrays in the order declared here, each starting at an 8-byte boundary,
+// so a mapped file can be viewed without copying.
+struct SnapshotView {
+    std::size_t                    rows;
+    std::size_t                    columns;
+    std::span<const std::uint64_t> name_offsets;
+    std::string_view               names;
+    std::span<const std::uint32_t> seats;
+    std::span<const std::uint32_t> friend_offsets;
+    std::span<const std::uint32_t> friend_targets;
+    std::span<const std::uint32_t> enemy_offsets;
+    std::span<const std::uint32_t> enemy_targets;
+    std::span<const std::uint32_t> allowed_offsets;
+    std::span<const std::uint32_t> allowed_seats;
+    std::span<const std::uint32_t> apart;
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return rows * columns; }
+
+    [[nodiscard]] constexpr std::string_view name(std::size_t student) const noexcept {
+        return names.substr(name_offsets[student],
+                            name_offsets[student + 1] - name_offsets[student]);
+    }
+
+    [[nodiscard]] constexpr std::span<const std::uint32_t>
+    friends_of(std::size_t student) const noexcept {
+        return friend_targets.subspan(friend_offsets[student],
+                                      friend_offsets[student + 1] - friend_offsets[student]);
+    }
+
+    [[nodiscard]] constexpr std::span<const std::uint32_t>
+    enemies_of(std::size_t student) const noexcept {
+        return enemy_targets.subspan(enemy_offsets[student],
+                                     enemy_offsets[student + 1] - enemy_offsets[student]);
+    }
+};
+
+[[nodiscard]] bool is_snapshot(std::string_view) noexcept;
+
+// Validates the header and every array of a snapshot held in memory, normally a MappedFile,
+// and views it. Nothing is copied; the view lives as long as the bytes.
+[[nodiscard]] bool open_snapshot(std::string_view, SnapshotView&, std::string&);
+
+// Writes to a temporary file renamed over the path, so readers and a crash mid-write never
+// see a partial snapshot.
+[[nodiscard]] bool write_snapshot(const std::string&, const SnapshotView&);
+
+template<std::size_t Row, std::size_t Column>
+[[nodiscard]] bool save_snapshot(const std::string&,
+                                 const FixedOrDynamic<Row * Column, std::string>&,
+                                 const SeatingChart<Row, Column>&,
+                                 const ClassInfo<Row * Column>&);
+
+template<std::size_t Row, std::size_t Column>
+[[nodiscard]] SeatingChart<Row, Column> load_chart(const SnapshotView&);
+
+template<std::size_t NumStudents>
+[[nodiscard]] ClassInfo<NumStudents> load_class_info(const SnapshotView&);
+
+template<std::size_t Row, std::size_t Column>
+[[nodiscard]] ParseResult<Row, Column> load_snapshot(const SnapshotView&);
+
+}
+
+namespace SeatingChartGenetic {
+
+template<std::size_t Row, std::size_t Column>
+bool save_snapshot(const std::string&                               path,
+                   const FixedOrDynamic<Row * Column, std::string>& lookup_name,
+                   const SeatingChart<Row, Column>&                 chart,
+                   const ClassInfo<Row * Column>&                   class_info) {
+    const std::size_t students = chart.size();
+
+    std::vector<std::uint64_t> name_offsets{0};
+    std::string                names;
+    std::vector<std::uint32_t> seats;
+    std::vector<std::uint32_t> friend_offsets{0}, friend_targets;
+    std::vector<std::uint32_t> enemy_offsets{0}, enemy_targets;
+
+    seats.reserve(students);
+
+    for (std::size_t student = 0; student < students; student++)
+    {
+        names += lookup_name[student];
+        name_offsets.push_back(names.size());
+
+        for (const auto stu_friend : class_info.friends_of(student))
+            friend_targets.push_back(stu_friend);
+
+        for (const auto stu_enemy : class_info.enemies_of(student))
+            enemy_targets.push_back(stu_enemy);
+
+        friend_offsets.push_back(friend_targets.size());
+        enemy_offsets.push_back(enemy_targets.size());
+    }
+
+    const auto&                constraints = class_info.constraints();
+    std::vector<std::uint32_t> allowed_offsets, allowed_seats, apart;
+
+    if (!constraints.allowed_seats.targets.empty())
+    {
+        allowed_offsets.assign(constraints.allowed_seats.offsets.begin(),
+                               constraints.allowed_seats.offsets.end());
+        allowed_seats.assign(constraints.allowed_seats.targets.begin(),
+                             constraints.allowed_seats.targets.end());
+    }
+
+    for (const auto& [first, second] : constraints.apart)
+    {
+        apart.push_back(first);
+        apart.push_back(second);
+    }
+
+    for (const auto& row : chart.seats())
+        for (const auto student : row)
+            seats.push_back(student);
+
+    return write_snapshot(path, {chart.rows(), chart.columns(), name_offsets, names, seats,
+                                 friend_offsets, friend_targets, enemy_offsets, enemy_targets,
+                                 allowed_offsets, allowed_seats, apart});
+}
+
+template<std::size_t Row, std::size_t Column>
+SeatingChart<Row, Column> load_chart(const SnapshotView& snapshot) {
+    assert(Row == Dynamic || (snapshot.rows == Row && snapshot.columns == Column));
+
+    auto seats = make_fixed_or_dynamic<Row>(
+      snapshot.rows, make_fixed_or_dynamic<Column, std::size_t>(snapshot.columns));
+
+    for (std::size_t i = 0; i < snapshot.rows; i++)
+        for (std::size_t j = 0; j < snapshot.columns; j++)
+            seats[i][j] = snapshot.seats[i * snapshot.columns + j];
+
+    return SeatingChart<Row, Column>{std::move(seats)};
+}
+
+template<std::size_t NumStudents>
+ClassInfo<NumStudents> load_class_info(const SnapshotView& snapshot) {
+    const auto adjacency = [](const auto offsets, const auto targets) {
+        return Adjacency{{offsets.begin(), offsets.end()}, {targets.begin(), targets.end()}};
+    };
+
+    SeatConstraints constraints;
+
+    if (!snapshot.allowed_offsets.empty())
+        constraints.allowed_seats = adjacency(snapshot.allowed_offsets, snapshot.allowed_seats);
+
+    for (std::size_t i = 0; i + 1 < snapshot.apart.size(); i += 2)
+        constraints.apart.emplace_back(snapshot.apart[i], snapshot.apart[i + 1]);
+
+    return ClassInfo<NumStudents>{adjacency(snapshot.friend_offsets, snapshot.friend_targets),
+                                  adjacency(snapshot.enemy_offsets, snapshot.enemy_targets),
+                                  std::move(constraints)};
+}
+
+template<std::size_t Row, std::size_t Column>
+ParseResult<Row, Column> load_snapshot(const SnapshotView& snapshot) {
+    auto lookup = make_fixed_or_dynamic<Row * Column, std::string>(snapshot.size());
+
+    for (std::size_t student = 0; student < snapshot.size(); student++)
+        lookup[student] = snapshot.name(student);
+
+    return ParseResult<Row, Column>{std::move(lookup), load_chart<Row, Column>(snapshot),
+                                    load_class_info<Row * Column>(snapshot)};
+}
+
+}
+
+#endif
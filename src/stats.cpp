@@ -0,0 +1,149 @@
+#include "stats.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <vector>
+
+namespace SeatingChartGenetic {
+
+namespace {
+
+// Blocks outlive their threads so the totals keep the work of finished workers
+std::mutex                                        registry_mutex;
+std::vector<std::unique_ptr<detail::ThreadStats>> registry;
+
+}
+
+detail::ThreadStats& detail::register_thread_stats() {
+    std::lock_guard lock{registry_mutex};
+    return *registry.emplace_back(std::make_unique<ThreadStats>());
+}
+
+StatsSnapshot stats_snapshot() {
+    StatsSnapshot snapshot;
+
+    std::lock_guard lock{registry_mutex};
+
+    for (const auto& thread : registry)
+    {
+        for (std::size_t i = 0; i < StatCounterCount; i++)
+            snapshot.counters[i] += thread->counters[i].load(std::memory_order_relaxed);
+
+        for (std::size_t i = 0; i < StatPhaseCount; i++)
+            snapshot.phase_nanoseconds[i] +=
+              thread->phase_nanoseconds[i].load(std::memory_order_relaxed);
+    }
+
+    return snapshot;
+}
+
+StatsReporter::StatsReporter(std::ostream& stream, std::chrono::steady_clock::duration period) :
+    out{stream},
+    interval{period},
+    start{std::chrono::steady_clock::now()},
+    thread{&StatsReporter::run, this} {}
+
+StatsReporter::~StatsReporter() {
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+    }
+
+    wake.notify_all();
+    thread.join();
+
+    report();
+}
+
+void StatsReporter::run() {
+    std::unique_lock lock{mutex};
+
+    while (!wake.wait_for(lock, interval, [&] { return stopping; }))
+        report();
+}
+
+void StatsReporter::report() {
+    const auto snapshot = stats_snapshot();
+    const auto restarts = snapshot.counters[static_cast<std::size_t>(StatCounter::Restarts)];
+    const auto climbs   = snapshot.counters[static_cast<std::size_t>(StatCounter::ClimbSteps)];
+
+    out << "{\"elapsed_seconds\":"
+        << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (std::size_t i = 0; i < StatCounterCount; i++)
+        out << ",\"" << StatCounterNames[i] << "\":" << snapshot.counters[i];
+
+    out << ",\"climbs_per_restart\":"
+        << (restarts ? static_cast<double>(climbs) / restarts : 0.0);
+
+    for (std::size_t i = 0; i < StatPhaseCount; i++)
+        out << ",\"" << StatPhaseNames[i] << "\":" << snapshot.phase_nanoseconds[i] * 1e-9;
+
+    out << "}" << std::endl;
+}
+
+}
+
+#if SEATINGCHART_STATS
+
+namespace {
+
+// Allocating here would recurse, so threads are never registered from operator new
+void count_allocation() noexcept {
+    using namespace SeatingChartGenetic;
+
+    if (auto* stats = detail::local_stats)
+        detail::add(stats->counters[static_cast<std::size_t>(StatCounter::Allocations)], 1);
+}
+
+void* allocate(std::size_t size, std::size_t alignment) {
+    count_allocation();
+
+    size = std::max<std::size_t>(size, 1);
+
+    while (true)
+    {
+        void* memory = alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                       ? std::malloc(size)
+                       : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+
+        if (memory)
+            return memory;
+
+        if (const auto handler = std::get_new_handler())
+            handler();
+        else
+            std::abort();
+    }
+}
+
+}
+
+void* operator new(std::size_t size) { return allocate(size, 0); }
+void* operator new[](std::size_t size) { return allocate(size, 0); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+#endif
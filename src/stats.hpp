@@ -0,0 +1,153 @@
+#ifndef STATS_HPP_INCLUDED
+#define STATS_HPP_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// Hot-path counters are compiled in only with -DSEATINGCHART_STATS=1 (the CMake option of the
+// same name); otherwise every call below is an empty inline function. Such builds also replace
+// the global operator new to count the allocations of every thread that has counted anything
+// else, so a steady-state search can be checked to allocate nothing.
+#ifndef SEATINGCHART_STATS
+#define SEATINGCHART_STATS 0
+#endif
+
+namespace SeatingChartGenetic {
+
+inline constexpr bool StatsEnabled = SEATINGCHART_STATS;
+
+enum class StatCounter : std::size_t {
+    ScoreCalls,
+    // Swap deltas computed; a move a seat rule forbids is rejected unscored and not counted
+    MovesEvaluated,
+    MovesAccepted,
+    ClimbSteps,
+    Restarts,
+    Allocations,
+    Count
+};
+
+enum class StatPhase : std::size_t {
+    Perturb,
+    Anneal,
+    Tabu,
+    Climb,
+    Count
+};
+
+inline constexpr std::size_t StatCounterCount = static_cast<std::size_t>(StatCounter::Count);
+inline constexpr std::size_t StatPhaseCount   = static_cast<std::size_t>(StatPhase::Count);
+
+inline constexpr std::array<std::string_view, StatCounterCount> StatCounterNames{
+  "score_calls", "moves_evaluated", "moves_accepted", "climb_steps", "restarts", "allocations"};
+inline constexpr std::array<std::string_view, StatPhaseCount> StatPhaseNames{
+  "perturb_seconds", "anneal_seconds", "tabu_seconds", "climb_seconds"};
+
+// Totals over every thread that has counted anything, read without stopping the writers.
+struct StatsSnapshot {
+    std::array<std::uint64_t, StatCounterCount> counters{};
+    std::array<std::uint64_t, StatPhaseCount>   phase_nanoseconds{};
+};
+
+constexpr void count(StatCounter, std::uint64_t = 1) noexcept;
+
+[[nodiscard]] StatsSnapshot stats_snapshot();
+
+// Adds the lifetime of the scope to a phase.
+class PhaseTimer {
+    std::chrono::steady_clock::time_point start;
+    StatPhase                             phase;
+
+   public:
+    explicit PhaseTimer(StatPhase) noexcept;
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer&)            = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+
+// Writes a snapshot as one JSON line every interval, and a final one when destroyed.
+class StatsReporter {
+    std::ostream&                               out;
+    const std::chrono::steady_clock::duration   interval;
+    const std::chrono::steady_clock::time_point start;
+
+    std::mutex              mutex;
+    std::condition_variable wake;
+    bool                    stopping = false;
+    std::thread             thread;
+
+    void report();
+    void run();
+
+   public:
+    StatsReporter(std::ostream&, std::chrono::steady_clock::duration);
+    ~StatsReporter();
+};
+
+namespace detail {
+
+// One block per thread, written only by its owner, so increments need no read-modify-write
+struct alignas(64) ThreadStats {
+    std::array<std::atomic<std::uint64_t>, StatCounterCount> counters{};
+    std::array<std::atomic<std::uint64_t>, StatPhaseCount>   phase_nanoseconds{};
+};
+
+ThreadStats& register_thread_stats();
+
+inline thread_local ThreadStats* local_stats = nullptr;
+
+inline ThreadStats& thread_stats() {
+    if (!local_stats) [[unlikely]]
+        local_stats = &register_thread_stats();
+
+    return *local_stats;
+}
+
+inline void add(std::atomic<std::uint64_t>& value, std::uint64_t amount) noexcept {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+}
+
+}
+
+namespace SeatingChartGenetic {
+
+constexpr void count(StatCounter counter, std::uint64_t amount) noexcept {
+    if constexpr (StatsEnabled)
+        if (!std::is_constant_evaluated())
+            detail::add(detail::thread_stats().counters[static_cast<std::size_t>(counter)],
+                        amount);
+}
+
+inline PhaseTimer::PhaseTimer(StatPhase timed_phase) noexcept :
+    start{},
+    phase{timed_phase} {
+    if constexpr (StatsEnabled)
+        start = std::chrono::steady_clock::now();
+}
+
+inline PhaseTimer::~PhaseTimer() {
+    if constexpr (StatsEnabled)
+    {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start);
+
+        detail::add(detail::thread_stats().phase_nanoseconds[static_cast<std::size_t>(phase)],
+                    elapsed.count());
+    }
+}
+
+}
+
+#endif
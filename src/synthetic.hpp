@@ -0,0 +1,103 @@
+#ifndef SYNTHETIC_HPP_INCLUDED
+#define SYNTHETIC_HPP_INCLUDED
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "classinfo.hpp"
+#include "parse.hpp"
+#include "seatingchart.hpp"
+
+namespace SeatingChartGenetic {
+
+struct SyntheticClass {
+    std::size_t   rows;
+    std::size_t   columns;
+    std::size_t   friends_per_student;
+    std::size_t   enemies_per_student;
+    std::uint64_t seed;
+};
+
+// Builds a class as if parsed from a file: students "S0", "S1", ... seated in order, each with
+// exactly the requested number of distinct friends and enemies drawn uniformly from the rest.
+// The draws use SplitMix64 rather than <random> distributions, whose output differs between
+// standard libraries, so a seed names the same class everywhere.
+template<std::size_t Row, std::size_t Column>
+[[nodiscard]] ParseResult<Row, Column> generate_class(const SyntheticClass&);
+
+}
+
+namespace SeatingChartGenetic {
+
+namespace {
+
+[[nodiscard]] constexpr std::uint64_t splitmix64(std::uint64_t& state) noexcept {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15);
+    z               = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z               = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+
+}
+
+template<std::size_t Row, std::size_t Column>
+ParseResult<Row, Column> generate_class(const SyntheticClass& spec) {
+    const std::size_t students = spec.rows * spec.columns;
+    assert(Row == Dynamic || (spec.rows == Row && spec.columns == Column));
+    assert(spec.friends_per_student + spec.enemies_per_student < students);
+
+    auto lookup = make_fixed_or_dynamic<Row * Column, std::string>(students);
+
+    auto seats = make_fixed_or_dynamic<Row>(
+      spec.rows, make_fixed_or_dynamic<Column, std::size_t>(spec.columns));
+
+    for (std::size_t i = 0; i < spec.rows; i++)
+    {
+        for (std::size_t j = 0; j < spec.columns; j++)
+        {
+            lookup[i * spec.columns + j] = "S" + std::to_string(i * spec.columns + j);
+            seats[i][j]                  = i * spec.columns + j;
+        }
+    }
+
+    auto friends = make_fixed_or_dynamic<Row * Column, std::vector<int>>(students);
+    auto enemies = make_fixed_or_dynamic<Row * Column, std::vector<int>>(students);
+
+    std::uint64_t     state = spec.seed;
+    std::vector<bool> taken(students);
+
+    for (std::size_t student = 0; student < students; student++)
+    {
+        std::fill(taken.begin(), taken.end(), false);
+        taken[student] = true;
+
+        for (const auto& [relations, count] :
+             {std::pair{&friends[student], spec.friends_per_student},
+              std::pair{&enemies[student], spec.enemies_per_student}})
+        {
+            while (relations->size() < count)
+            {
+                const auto other = splitmix64(state) % students;
+
+                if (taken[other])
+                    continue;
+
+                taken[other] = true;
+                relations->push_back(static_cast<int>(other));
+            }
+        }
+    }
+
+    return ParseResult<Row, Column>{
+      lookup, SeatingChart<Row, Column>{std::move(seats)},
+      ClassInfo<Row * Column>{std::move(friends), std::move(enemies)}};
+}
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef TABU_HPP_INCLUDED
+#define TABU_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+
+#include "extent.hpp"
+
+namespace SeatingChartGenetic {
+
+struct TabuSettings {
+    std::size_t iterations;
+    std::size_t tenure;
+};
+
+// Tenure table over unordered student pairs: each entry holds the iteration at which swapping
+// that pair is allowed again. Lookups and updates are O(1), and fixed-size lists live entirely
+// in the object without allocating.
+template<std::size_t NumStudents>
+class TabuList {
+    FixedOrDynamic<NumStudents * NumStudents, std::size_t> released_at;
+    std::size_t                                            students;
+
+    [[nodiscard]] constexpr std::size_t index(std::size_t, std::size_t) const noexcept;
+
+   public:
+    explicit constexpr TabuList(std::size_t);
+
+    [[nodiscard]] constexpr bool is_tabu(std::size_t, std::size_t, std::size_t) const noexcept;
+    constexpr void               forbid(std::size_t, std::size_t, std::size_t) noexcept;
+
+    // Clears the list for a new search, keeping its storage
+    constexpr void reset(std::size_t);
+};
+
+}
+
+namespace SeatingChartGenetic {
+
+template<std::size_t NumStudents>
+constexpr TabuList<NumStudents>::TabuList(std::size_t num_students) :
+    released_at{make_fixed_or_dynamic<NumStudents * NumStudents, std::size_t>(
+      num_students * num_students, 0)},
+    students{num_students} {}
+
+template<std::size_t NumStudents>
+constexpr void TabuList<NumStudents>::reset(std::size_t num_students) {
+    if constexpr (NumStudents == Dynamic)
+        released_at.assign(num_students * num_students, 0);
+    else
+        released_at.fill(0);
+
+    students = num_students;
+}
+
+template<std::size_t NumStudents>
+constexpr std::size_t TabuList<NumStudents>::index(std::size_t first,
+                                                   std::size_t second) const noexcept {
+    return std::min(first, second) * students + std::max(first, second);
+}
+
+template<std::size_t NumStudents>
+constexpr bool TabuList<NumStudents>::is_tabu(std::size_t first,
+                                              std::size_t second,
+                                              std::size_t iteration) const noexcept {
+    return released_at[index(first, second)] > iteration;
+}
+
+template<std::size_t NumStudents>
+constexpr void TabuList<NumStudents>::forbid(std::size_t first,
+                                             std::size_t second,
+                                             std::size_t until) noexcept {
+    released_at[index(first, second)] = until;
+}
+
+}
+
+#endif
@@ -1,13 +0,0 @@
-#ifndef UTILS_HPP_INCLUDED
-#define UTILS_HPP_INCLUDED
-
-#include <string>
-#include <vector>
-
-namespace SeatingChartGenetic::utils {
-
-std::vector<std::string> split(const std::string&, char);
-
-}
-
-#endif  // #ifndef UTILS_HPP_INCLUDED
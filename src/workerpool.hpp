@@ -0,0 +1,114 @@
+#ifndef WORKERPOOL_HPP_INCLUDED
+#define WORKERPOOL_HPP_INCLUDED
+
+#include <algorithm>
+#include <barrier>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace SeatingChartGenetic {
+
+// Threads started once and reused for every parallel step of a search, such as scoring or
+// breeding a generation. The caller works as thread 0 and all threads meet at a barrier before
+// and after each step, so a step costs two barrier phases rather than a thread start and join
+// per worker, and neither starting a step nor waiting for it allocates.
+class WorkerPool {
+    using Task = void (*)(const void*, std::size_t, std::size_t, std::size_t);
+
+    std::barrier<>           sync;
+    Task                     task     = nullptr;
+    const void*              function = nullptr;
+    std::size_t              count    = 0;
+    std::size_t              chunk    = 0;
+    bool                     stopping = false;
+    std::vector<std::thread> workers;
+
+    void run_chunk(std::size_t thread) const;
+    void work(std::size_t thread);
+
+   public:
+    // `threads` counts the caller, so a pool of 1 starts no threads
+    explicit WorkerPool(std::size_t threads);
+    ~WorkerPool();
+
+    // The workers hold `this`
+    WorkerPool(const WorkerPool&)            = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    [[nodiscard]] std::size_t size() const noexcept { return workers.size() + 1; }
+
+    // Splits [0, count) into one contiguous chunk per thread, runs `function(thread, begin, end)`
+    // on each and returns once all are done
+    template<typename Function>
+    void for_each_chunk(std::size_t count, const Function& function);
+};
+
+}
+
+namespace SeatingChartGenetic {
+
+inline WorkerPool::WorkerPool(std::size_t threads) : sync{static_cast<std::ptrdiff_t>(threads)} {
+    workers.reserve(threads - 1);
+
+    for (std::size_t thread = 1; thread < threads; thread++)
+        workers.emplace_back(&WorkerPool::work, this, thread);
+}
+
+inline WorkerPool::~WorkerPool() {
+    if (workers.empty())
+        return;
+
+    stopping = true;
+    sync.arrive_and_wait();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+inline void WorkerPool::run_chunk(std::size_t thread) const {
+    const auto chunk_begin = std::min(count, thread * chunk);
+    const auto chunk_end   = std::min(count, chunk_begin + chunk);
+
+    if (chunk_begin < chunk_end)
+        task(function, thread, chunk_begin, chunk_end);
+}
+
+// The barrier orders the caller's writes of the step before the workers' reads, and the
+// workers' results before the caller's return
+inline void WorkerPool::work(std::size_t thread) {
+    while (true)
+    {
+        sync.arrive_and_wait();
+
+        if (stopping)
+            return;
+
+        run_chunk(thread);
+        sync.arrive_and_wait();
+    }
+}
+
+template<typename Function>
+void WorkerPool::for_each_chunk(std::size_t items, const Function& chunk_function) {
+    count    = items;
+    chunk    = (items + size() - 1) / size();
+    function = &chunk_function;
+    task     = [](const void* erased, std::size_t thread, std::size_t begin, std::size_t end) {
+        (*static_cast<const Function*>(erased))(thread, begin, end);
+    };
+
+    if (workers.empty())
+    {
+        run_chunk(0);
+        return;
+    }
+
+    sync.arrive_and_wait();
+    run_chunk(0);
+    sync.arrive_and_wait();
+}
+
+}
+
+#endif
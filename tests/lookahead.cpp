@@ -0,0 +1,67 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "random.hpp"
+#include "scoring.hpp"
+#include "seatingchart.hpp"
+#include "simulation.hpp"
+#include "synthetic.hpp"
+
+using namespace SeatingChartGenetic;
+
+namespace {
+
+constexpr std::size_t Optima = 40;
+
+// Climbs `Optima` random charts to optima of single swaps and counts how many a lookahead step
+// then raises. Pair swaps that move nobody score exactly 0 and used to crowd every real move out
+// of the lookahead's candidates, so no optimum was ever escaped with two-seat tables.
+template<std::size_t Row, std::size_t Column, typename Policy>
+std::size_t escaped_optima(const char* name, const Policy& policy) {
+    const auto parsed = generate_class<Row, Column>({Row, Column, 3, 2, 1});
+
+    ChartScorer<Row, Column, Policy> scorer{parsed.class_info, policy};
+    std::size_t                      escaped = 0;
+
+    for (std::uint64_t seed = 0; seed < Optima; seed++)
+    {
+        Xoshiro256 rng{seed};
+        auto       chart = parsed.chart;
+
+        chart.random_shuffle(rng, scorer);
+
+        while (chart.hill_climb_combined(scorer))
+            ;
+
+        const double optimum = scorer(chart);
+
+        if (!chart.hill_climb_lookahead(scorer))
+            continue;
+
+        if (scorer(chart) <= optimum + ScoreTolerance)
+        {
+            std::cerr << name << ": lookahead claimed a raise from " << optimum << " but reached "
+                      << scorer(chart) << std::endl;
+            return 0;
+        }
+
+        escaped++;
+    }
+
+    std::cout << name << ": lookahead escaped " << escaped << " of " << Optima << " optima"
+              << std::endl;
+    return escaped;
+}
+
+}
+
+int main() {
+    // Only the few best first moves are tried, so not every optimum is escaped
+    const bool passed =
+      escaped_optima<6, 8>("two-seat tables", DefaultScoring{}) >= Optima / 2
+      && escaped_optima<6, 6>("three-seat tables", StaticScoring<3, EuclideanDistance>{})
+           >= Optima / 2;
+
+    return passed ? 0 : 1;
+}
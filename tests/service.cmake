@@ -0,0 +1,36 @@
+# Feeds a scripted request stream to the optimizer service and checks the events come back in
+# order: queueing past --max-jobs, best and cancel of queued and running jobs, the errors for
+# unknown jobs and ops, and shutdown retiring the job still queued.
+#
+# cmake -DSEATING_CHART=<binary> -DREQUESTS=<file> -P service.cmake
+execute_process(COMMAND ${SEATING_CHART} --serve --threads 2 --max-jobs 1
+                INPUT_FILE ${REQUESTS}
+                OUTPUT_VARIABLE events
+                RESULT_VARIABLE result
+                TIMEOUT 30)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "The service exited with ${result}:\n${events}")
+endif()
+
+set(expected
+    [=["event":"accepted","id":"first","rows":2,"columns":4,"queued":false]=]
+    [=["event":"accepted","id":"second","rows":2,"columns":4,"queued":true]=]
+    [=["event":"best","id":"second","status":"running"]=]
+    [=["event":"done","id":"first","status":"cancelled"]=]
+    [=["event":"error","id":"first","message":"no such job"]=]
+    [=["event":"error","id":"missing","message":"no such job"]=]
+    [=["event":"error","id":"second","message":"unknown op 'resize']=]
+    [=["event":"done","id":"second","status":"cancelled"]=])
+
+set(remaining "${events}")
+
+foreach(event IN LISTS expected)
+    string(FIND "${remaining}" "${event}" position)
+
+    if(position EQUAL -1)
+        message(FATAL_ERROR "Missing or out of order: ${event}\nEvents:\n${events}")
+    endif()
+
+    string(SUBSTRING "${remaining}" ${position} -1 remaining)
+endforeach()
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "classinfo.hpp"
+#include "mappedfile.hpp"
+#include "random.hpp"
+#include "simulation.hpp"
+#include "snapshot.hpp"
+#include "synthetic.hpp"
+
+using namespace SeatingChartGenetic;
+
+namespace {
+
+constexpr const char* SnapshotPath = "snapshot_test.snap";
+
+// An aligned copy of a snapshot's bytes that can be cut short or edited
+struct SnapshotBytes {
+    std::vector<std::uint64_t> words;
+    std::size_t                size;
+
+    explicit SnapshotBytes(std::string_view bytes) :
+        words((bytes.size() + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t)),
+        size{bytes.size()} {
+        std::memcpy(words.data(), bytes.data(), bytes.size());
+    }
+
+    [[nodiscard]] std::string_view view(std::size_t length) const noexcept {
+        return {reinterpret_cast<const char*>(words.data()), length};
+    }
+
+    [[nodiscard]] std::string_view view() const noexcept { return view(size); }
+
+    // Overwrites the copy of an array element viewed in `original`, the bytes copied
+    void set(std::string_view original, const std::uint32_t& element, std::uint32_t value) {
+        const auto offset = reinterpret_cast<const char*>(&element) - original.data();
+        std::memcpy(reinterpret_cast<char*>(words.data()) + offset, &value, sizeof(value));
+    }
+};
+
+template<typename Relations>
+Adjacency copy_adjacency(std::size_t students, Relations relations_of) {
+    Adjacency adjacency{{0}, {}};
+
+    for (std::size_t student = 0; student < students; student++)
+    {
+        for (const auto other : relations_of(student))
+            adjacency.targets.push_back(other);
+
+        adjacency.offsets.push_back(adjacency.targets.size());
+    }
+
+    return adjacency;
+}
+
+// A synthetic class with seat rules added, so every array of the format is written
+ParseResult<Dynamic, Dynamic> constrained_class() {
+    auto parsed = generate_class<Dynamic, Dynamic>({4, 6, 3, 2, 5});
+
+    const auto& info     = parsed.class_info;
+    const auto  students = parsed.chart.size();
+
+    SeatConstraints constraints;
+    constraints.allowed_seats.offsets.assign(students + 1, 0);
+
+    // Student 1 may only sit in seats 0 and 1, student 5 only in seat 3
+    constraints.allowed_seats.targets = {0, 1, 3};
+    std::fill(constraints.allowed_seats.offsets.begin() + 2,
+              constraints.allowed_seats.offsets.begin() + 6, 2);
+    std::fill(constraints.allowed_seats.offsets.begin() + 6,
+              constraints.allowed_seats.offsets.end(), 3);
+    constraints.apart = {{2, 7}, {4, 9}};
+
+    parsed.class_info = ClassInfo<Dynamic>{
+      copy_adjacency(students, [&](std::size_t student) { return info.friends_of(student); }),
+      copy_adjacency(students, [&](std::size_t student) { return info.enemies_of(student); }),
+      std::move(constraints)};
+
+    Xoshiro256 rng{3};
+    parsed.chart.random_shuffle(rng);
+    return parsed;
+}
+
+bool same_class(const ParseResult<Dynamic, Dynamic>& saved,
+                const ParseResult<Dynamic, Dynamic>& loaded) {
+    const auto students = saved.chart.size();
+
+    if (loaded.chart.rows() != saved.chart.rows() || loaded.chart.columns() != saved.chart.columns()
+        || loaded.chart.seats() != saved.chart.seats() || loaded.lookup_name != saved.lookup_name)
+        return false;
+
+    for (std::size_t student = 0; student < students; student++)
+        if (!std::ranges::equal(loaded.class_info.friends_of(student),
+                                saved.class_info.friends_of(student))
+            || !std::ranges::equal(loaded.class_info.enemies_of(student),
+                                   saved.class_info.enemies_of(student)))
+            return false;
+
+    const auto& saved_rules  = saved.class_info.constraints();
+    const auto& loaded_rules = loaded.class_info.constraints();
+
+    return loaded_rules.allowed_seats.offsets == saved_rules.allowed_seats.offsets
+        && loaded_rules.allowed_seats.targets == saved_rules.allowed_seats.targets
+        && loaded_rules.apart == saved_rules.apart
+        && score_chart(loaded.chart, loaded.class_info, DefaultScoring{})
+             == score_chart(saved.chart, saved.class_info, DefaultScoring{});
+}
+
+bool refused(std::string_view bytes, const char* expected) {
+    SnapshotView snapshot;
+    std::string  error;
+
+    if (open_snapshot(bytes, snapshot, error))
+        return false;
+
+    return expected == nullptr || error == expected;
+}
+
+bool round_trip() {
+    const auto saved = constrained_class();
+
+    if (!save_snapshot(SnapshotPath, saved.lookup_name, saved.chart, saved.class_info))
+    {
+        std::cerr << "Cannot write " << SnapshotPath << std::endl;
+        return false;
+    }
+
+    const MappedFile file{SnapshotPath};
+    SnapshotView     snapshot;
+    std::string      error;
+
+    if (!file.is_open() || !open_snapshot(file.view(), snapshot, error))
+    {
+        std::cerr << "Cannot open the snapshot: " << error << std::endl;
+        return false;
+    }
+
+    if (!same_class(saved, load_snapshot<Dynamic, Dynamic>(snapshot)))
+    {
+        std::cerr << "The loaded class differs from the saved one" << std::endl;
+        return false;
+    }
+
+    SnapshotBytes bytes{file.view()};
+
+    // Every array is needed, so no prefix of the file may load
+    for (std::size_t length = 0; length < bytes.size; length++)
+    {
+        if (!refused(bytes.view(length), nullptr))
+        {
+            std::cerr << "A snapshot cut to " << length << " of " << bytes.size
+                      << " bytes was accepted" << std::endl;
+            return false;
+        }
+    }
+
+    // The scorers count a relationship once per listing, so a list naming a student twice
+    // would score differently from the parsed class it stands for
+    std::size_t student = 0;
+
+    while (snapshot.friends_of(student).size() < 2)
+        student++;
+
+    const auto friends = snapshot.friends_of(student);
+
+    SnapshotBytes repeated_friend{file.view()};
+    repeated_friend.set(file.view(), friends[1], friends[0]);
+
+    if (!refused(repeated_friend.view(), "snapshot has a corrupt name table or adjacency"))
+    {
+        std::cerr << "A snapshot listing a friend twice was accepted" << std::endl;
+        return false;
+    }
+
+    SnapshotBytes repeated_seat{file.view()};
+    repeated_seat.set(file.view(), snapshot.seats[1], snapshot.seats[0]);
+
+    if (!refused(repeated_seat.view(), "snapshot seats are not a permutation of the students"))
+    {
+        std::cerr << "A snapshot seating a student twice was accepted" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+}
+
+int main() {
+    const bool passed = round_trip();
+    std::remove(SnapshotPath);
+
+    if (passed)
+        std::cout << "snapshot round trip and corrupt snapshots: passed" << std::endl;
+
+    return passed ? 0 : 1;
+}
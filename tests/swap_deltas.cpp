@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+#include "random.hpp"
+#include "scoring.hpp"
+#include "seatingchart.hpp"
+#include "simulation.hpp"
+#include "synthetic.hpp"
+
+using namespace SeatingChartGenetic;
+
+namespace {
+
+constexpr std::size_t Charts = 3;
+
+constexpr ScoreWeights CustomWeights{7.3, 1.1, 2.9};
+
+// The chart with students `first` and `second` trading seats, built through the public
+// constructor so the check does not share the climbers' swap code
+template<std::size_t Row, std::size_t Column>
+SeatingChart<Row, Column>
+swapped(const SeatingChart<Row, Column>& chart, std::size_t first, std::size_t second) {
+    auto       seats    = chart.seats();
+    const auto [r1, c1] = chart.locations()[first];
+    const auto [r2, c2] = chart.locations()[second];
+
+    std::swap(seats[r1][c1], seats[r2][c2]);
+    return SeatingChart<Row, Column>{std::move(seats)};
+}
+
+// Compares both swap deltas against rescoring the swapped chart for every pair of students on a
+// few random charts, and counts the deltas that disagree
+template<std::size_t Row, std::size_t Column, typename Policy>
+std::size_t mismatched_deltas(const char*         name,
+                              std::size_t         rows,
+                              std::size_t         columns,
+                              const Policy&       policy,
+                              const ScoreWeights& weights) {
+    auto parsed = generate_class<Row, Column>({rows, columns, 3, 2, 7});
+    parsed.class_info.set_weights(weights);
+
+    const ChartScorer<Row, Column, Policy> scorer{parsed.class_info, policy};
+    const auto                             table_seats = policy.table_seats();
+
+    Xoshiro256  rng{1};
+    auto        chart      = parsed.chart;
+    std::size_t mismatches = 0;
+
+    const auto check = [&](double delta, const SeatingChart<Row, Column>& moved, double base) {
+        const double actual = scorer(moved) - base;
+
+        if (std::abs(actual - delta) > ScoreTolerance * std::max(1.0, std::abs(base)))
+            mismatches++;
+    };
+
+    for (std::size_t round = 0; round < Charts; round++)
+    {
+        chart.random_shuffle(rng);
+
+        const double base = scorer(chart);
+
+        for (std::size_t i = 0; i < chart.size(); i++)
+        {
+            for (std::size_t j = 0; j < chart.size(); j++)
+            {
+                check(scorer.swap_students_delta(chart, i, j), swapped(chart, i, j), base);
+
+                if (!scorer.allows_swap_pairs(chart, i, j))
+                    continue;
+
+                // As in swap_pairs, the tablemates are looked up once the students have moved
+                const auto students = swapped(chart, i, j);
+                const auto pairs    = swapped(students,
+                                           students.get_tablemate(i, table_seats),
+                                           students.get_tablemate(j, table_seats));
+
+                check(scorer.swap_pairs_delta(chart, i, j), pairs, base);
+            }
+        }
+    }
+
+    std::cout << name << " (" << weights.tablemate << ", " << weights.friends << ", "
+              << weights.enemies << "): " << mismatches << " mismatched deltas" << std::endl;
+    return mismatches;
+}
+
+template<std::size_t Row, std::size_t Column, typename Policy>
+std::size_t
+mismatched_deltas(const char* name, std::size_t rows, std::size_t columns, const Policy& policy) {
+    return mismatched_deltas<Row, Column>(name, rows, columns, policy, ScoreWeights{})
+         + mismatched_deltas<Row, Column>(name, rows, columns, policy, CustomWeights);
+}
+
+}
+
+int main() {
+    std::size_t mismatches = 0;
+
+    mismatches += mismatched_deltas<6, 8>("default", 6, 8, DefaultScoring{});
+    mismatches += mismatched_deltas<Dynamic, Dynamic>("default, dynamic", 5, 8, DefaultScoring{});
+    mismatches += mismatched_deltas<6, 6>(
+      "three seats, manhattan", 6, 6, StaticScoring<3, ManhattanDistance>{});
+    mismatches +=
+      mismatched_deltas<6, 8>("four seats, rows", 6, 8, StaticScoring<4, RowDistance>{});
+    mismatches += mismatched_deltas<Dynamic, Dynamic>(
+      "runtime single seats", 4, 6, RuntimeScoring{1, DistanceKind::Euclidean});
+    mismatches += mismatched_deltas<Dynamic, Dynamic>(
+      "runtime single seats, odd columns", 3, 5, RuntimeScoring{1, DistanceKind::Manhattan});
+    mismatches += mismatched_deltas<6, 8>(
+      "runtime two seats, manhattan", 6, 8, RuntimeScoring{2, DistanceKind::Manhattan});
+    mismatches += mismatched_deltas<Dynamic, Dynamic>(
+      "runtime three seats, rows", 4, 6, RuntimeScoring{3, DistanceKind::Rows});
+    mismatches += mismatched_deltas<Dynamic, Dynamic>(
+      "runtime three seats, one table per row", 4, 3, RuntimeScoring{3, DistanceKind::Euclidean});
+    mismatches += mismatched_deltas<Dynamic, Dynamic>(
+      "runtime four seats", 4, 8, RuntimeScoring{4, DistanceKind::Euclidean});
+
+    return mismatches == 0 ? 0 : 1;
+}